@@ -22,6 +22,8 @@
 #define SOCKET_BUTTON_READ_MS   100
 #define SOCKET_COUNT            32
 
+static_assert(SOCKET_COUNT <= 32, "Socket batch mask holds up to 32 sockets");
+
 typedef struct {
     size_t      id;
     String      name;
@@ -31,6 +33,8 @@ typedef struct {
     GpioPin     *button;
     GpioPin     *relay;
     bool        enabled;
+    uint32_t    version;
+    unsigned    toggles;
 } Socket;
 
 class SocketCtrlClass
@@ -44,6 +48,8 @@ public:
     bool getSocket(const String &name, Socket **sock);
     bool getSocket(size_t index, Socket **sock);
     void setStatus(Socket *sock, bool status, bool save);
+    void beginBatch();
+    void commitBatch();
     bool &getStatus(Socket *sock);
     void begin();
     void loop();
@@ -56,7 +62,10 @@ private:
     unsigned                            _curSocket = 0;
     bool                                _enabled;
     String                              _name;
+    bool                                _batch = false;
+    uint32_t                            _batchMask = 0;
 
+    void _saveStates(uint32_t mask);
     void _beginSocket(Socket *sock);
     void _loopSocket(Socket *sock);
     void _readButton(Socket *sock);
@@ -0,0 +1,98 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __BOOT_HPP__
+#define __BOOT_HPP__
+
+#include <Arduino.h>
+#include <array>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#define BOOT_TASK_STACK         8192
+#define BOOT_TASK_PRIO          1
+#define BOOT_SERIAL_DELAY_MS    0
+
+#define BOOT_DEP(stage)         (1UL << (stage))
+
+typedef enum {
+    BOOT_STAGE_I2C,
+    BOOT_STAGE_FLASH,
+    BOOT_STAGE_ONEWIRE,
+    BOOT_STAGE_EXT,
+    BOOT_STAGE_EXT_BUS_1,
+    BOOT_STAGE_EXT_BUS_2,
+    BOOT_STAGE_GPIO,
+    BOOT_STAGE_EEPROM,
+    BOOT_STAGE_CONFIGS,
+    BOOT_STAGE_CTRLS,
+    BOOT_STAGE_PLC,
+    BOOT_STAGE_WIFI,
+    BOOT_STAGE_TGBOT,
+    BOOT_STAGE_GSM,
+    BOOT_STAGE_API,
+    BOOT_STAGE_WEBGUI,
+    BOOT_STAGE_MODBUS,
+    BOOT_STAGE_MQTT,
+    BOOT_STAGE_UDP,
+    BOOT_STAGE_REPLICA,
+    BOOT_STAGE_MAX
+} BootStageId;
+
+typedef enum {
+    BOOT_STATUS_WAIT,
+    BOOT_STATUS_RUN,
+    BOOT_STATUS_DONE,
+    BOOT_STATUS_FAILED,
+    BOOT_STATUS_SKIPPED
+} BootStageStatus;
+
+typedef bool (*BootFunc)();
+
+typedef struct {
+    String          name;
+    BootFunc        func;
+    uint32_t        deps;
+    bool            async;
+    bool            enabled;
+    BootStageStatus status;
+    unsigned        start;
+    unsigned        duration;
+} BootStage;
+
+class BootClass
+{
+public:
+    void begin();
+    bool addStage(BootStageId id, const String &name, BootFunc func, uint32_t deps, bool async);
+    void run();
+    void setOutputsValid();
+    bool getStage(size_t index, BootStage **stage);
+    size_t getStagesCount() const;
+    unsigned getOutputsTime() const;
+    unsigned getTotalTime() const;
+    bool isFinished() const;
+
+private:
+    std::array<BootStage, BOOT_STAGE_MAX>   _stages;
+    EventGroupHandle_t                      _events = nullptr;
+    unsigned                                _start = 0;
+    unsigned                                _outputs = 0;
+    unsigned                                _total = 0;
+    bool                                    _finished = false;
+
+    void _runStage(BootStage *stage);
+    static void _stageTask(void *arg);
+};
+
+extern BootClass Boot;
+
+#endif /* __BOOT_HPP__ */
@@ -32,6 +32,13 @@ public:
     void showOneWire();
     void showI2C();
     void showTgBot();
+    void showBoot();
+    void showGsm();
+    void showApi();
+    void showModbus();
+    void showMqtt();
+    void showUdp();
+    void showReplica();
 };
 
 extern CLIInformerClass CLIInformer;
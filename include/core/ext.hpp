@@ -23,6 +23,8 @@
 
 #define EXT_COUNT  16
 
+#define EXT_MCP_REG_GPIO    0x12
+
 typedef enum {
     EXT_TYPE_MCP_16,
     EXT_TYPE_MCP_8
@@ -35,13 +37,18 @@ typedef struct {
     Adafruit_MCP23X17   mcp;
     bool                enabled;
     bool                active;
+    uint16_t            setMask;
+    uint16_t            clrMask;
 } Extender;
 
 class ExtendersClass
 {
 public:
     bool begin();
+    void probe(size_t index);
     void write(Extender *ext, uint16_t pin, bool state);
+    void beginBatch();
+    void commit();
     bool read(Extender *ext, uint16_t pin);
     void setPinMode(Extender *ext, uint16_t pin, uint8_t mode);
     void getExtenders(std::vector<Extender *> &ext);
@@ -49,6 +56,10 @@ public:
 
 private:
     std::array<Extender, EXT_COUNT>   _ext;
+    bool                              _batch = false;
+
+    bool _readPorts(Extender *ext, uint16_t &value);
+    bool _writePorts(Extender *ext, uint16_t value);
 };
 
 extern ExtendersClass Extenders;
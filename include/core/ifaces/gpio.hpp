@@ -36,7 +36,8 @@ typedef enum {
     GPIO_TYPE_INPUT,
     GPIO_TYPE_RELAY,
     GPIO_TYPE_SENSOR,
-    GPIO_TYPE_BUZZER
+    GPIO_TYPE_BUZZER,
+    GPIO_TYPE_VIRTUAL
 } GpioType;
 
 typedef struct {
@@ -55,12 +56,15 @@ class GpioClass
 public:
     bool begin();
     void write(GpioPin *pin, bool val);
+    void beginBatch();
+    void commit();
     bool read(GpioPin *pin);
     bool getState(GpioPin *pin);
     bool getPinById(uint16_t id, GpioPin **pin);
     void getPins(std::vector<GpioPin *> &pins);
     void getPinsByType(GpioType type, std::vector<GpioPin *> &pins);
     void setMode(GpioPin *pin, GpioMode mode, GpioPull pull);
+    bool addVirtual(uint16_t id, GpioPin **pin);
 
 private:
     std::array<GpioPin, GPIO_PINS_COUNT> _pins;
@@ -22,19 +22,24 @@
 #define I2C_SCAN_ADDR_LAST  0x7f
 
 typedef struct {
-    uint8_t id;
-    uint8_t sda;
-    uint8_t scl;
-    TwoWire *wire;
-    bool    enabled;
+    uint8_t     id;
+    uint8_t     sda;
+    uint8_t     scl;
+    TwoWire     *wire;
+    bool        enabled;
+    unsigned    transactions;
+    unsigned    errors;
 } I2cBus;
 
 class I2cClass
 {
 public:
     bool begin();
+    bool isPresent(size_t index) const;
     void getI2cBuses(std::vector<I2cBus *> &bus);
     bool getI2cBusById(uint8_t id, I2cBus **bus);
+    bool getI2cBus(size_t index, I2cBus **bus);
+    void account(I2cBus *bus, bool ok, unsigned count = 1);
     void findDevices(I2cBus *bus, std::vector<byte> &devs);
 
 private:
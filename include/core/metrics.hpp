@@ -0,0 +1,53 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __METRICS_HPP__
+#define __METRICS_HPP__
+
+#include <Arduino.h>
+
+#define METRICS_OW_SENSORS_MAX  16
+
+typedef struct {
+    unsigned    count;
+    unsigned    last;
+    unsigned    max;
+    uint64_t    total;
+} MetricsLoop;
+
+typedef struct {
+    uint64_t    id;
+    unsigned    reads;
+    unsigned    fails;
+} MetricsOwSensor;
+
+/*
+ * Preallocated runtime counters for the /metrics endpoint
+ */
+class MetricsClass
+{
+public:
+    void loopBegin();
+    void loopEnd();
+    const MetricsLoop &getLoop() const;
+    void owRead(uint64_t id, bool ok);
+    bool getOwSensor(size_t index, const MetricsOwSensor **sensor) const;
+
+private:
+    MetricsLoop     _loop = { 0 };
+    unsigned        _loopStart = 0;
+    MetricsOwSensor _ow[METRICS_OW_SENSORS_MAX] = {};
+    size_t          _owCount = 0;
+};
+
+extern MetricsClass Metrics;
+
+#endif /* __METRICS_HPP__ */
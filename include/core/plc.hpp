@@ -17,6 +17,7 @@
 #include <LiquidCrystal_I2C.h>
 
 #include "core/ifaces/gpio.hpp"
+#include "core/ifaces/i2c.hpp"
 
 #define PLC_ALARM_TIMER_MS  500
 #define PLC_FAN_TIMER_MS    5000
@@ -29,6 +30,8 @@
 
 #define PLC_BRD_TEMP_MAX    50
 #define PLC_BRD_TEMP_MIN    40
+#define PLC_LM75_TEMP_MIN   -55
+#define PLC_LM75_TEMP_MAX   125
 
 #define PLC_RLY_MAX 8
 
@@ -36,7 +39,8 @@
 #define PLC_LCD_COLS    16
 
 typedef enum {
-    PLC_MOD_WIFI
+    PLC_MOD_WIFI,
+    PLC_MOD_GSM
 } PlcMod;
 
 typedef enum {
@@ -63,6 +67,7 @@ class PlcClass
 public:
     PlcClass();
     void setAlarm(PlcMod mod, bool status);
+    unsigned getAlarm() const;
     void setBuzzer(PlcMod mod, bool status);
     void setStatus(PlcMod mod, bool status);
     const String& getName() const;
@@ -71,6 +76,9 @@ public:
     bool &getFanEnabled();
     bool &getFanStatus();
     float &getBoardTemp();
+    uint32_t updateVersion();
+    uint32_t getVersion() const;
+    uint32_t getBoot() const;
     void begin();
     void loop();
 
@@ -85,6 +93,7 @@ private:
     bool                _lastAlarm = false;
     bool                _lastBuzzer = false;
     LM75                _tempSensor;
+    I2cBus              *_tempBus = nullptr;
     float               _brdTemp = 0;
     bool                _fanStatus = false;
     bool                _fanEnabled = true;
@@ -92,6 +101,8 @@ private:
     String              _lcdText[PLC_LCD_ROWS] = { PLC_DEFAULT_ROW_0, PLC_DEFAULT_ROW_1 };
     size_t              _curTask = PLC_TASK_BUZZER;
     bool                _bzrOff = false;
+    volatile uint32_t   _version = 1;
+    uint32_t            _boot = 0;
 
     void _taskAlarmBuzzer();
     void _taskFan();
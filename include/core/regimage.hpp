@@ -0,0 +1,80 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __REG_IMAGE_HPP__
+#define __REG_IMAGE_HPP__
+
+#include <Arduino.h>
+
+#include "core/ifaces/gpio.hpp"
+#include "controllers/socket/socket.hpp"
+#include "controllers/meteo/sensors/msensor.hpp"
+
+#define REGIMAGE_COILS          SOCKET_COUNT
+#define REGIMAGE_INPUTS         64
+#define REGIMAGE_IREGS          32
+#define REGIMAGE_IREG_BOARD     0
+#define REGIMAGE_IREG_ALARM     1
+#define REGIMAGE_IREG_SENSORS   8
+#define REGIMAGE_SENSORS_MAX    (REGIMAGE_IREGS - REGIMAGE_IREG_SENSORS)
+#define REGIMAGE_WRITES_MAX     32
+#define REGIMAGE_IREG_INVALID   INT16_MIN
+
+/*
+ * Process image shared by the field protocols. Coils are socket
+ * statuses, discrete inputs are GPIO inputs (1 when pulled low),
+ * input registers hold temperatures in tenths of a degree,
+ * REGIMAGE_IREG_INVALID for a failed sensor read.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t    version;
+    uint32_t    coils;
+    uint32_t    sockets;
+    uint64_t    inputs;
+    int16_t     iregs[REGIMAGE_IREGS];
+} RegImageData;
+
+typedef struct {
+    uint16_t    addr;
+    bool        value;
+} RegImageWrite;
+
+class RegImageClass
+{
+public:
+    void addSensor(MeteoSensor *sensor);
+    void read(RegImageData &data);
+    bool isCoil(uint16_t addr) const;
+    bool writeCoil(uint16_t addr, bool value);
+    size_t getInputCount() const;
+    size_t getSensorCount() const;
+    MeteoSensor *getSensor(size_t index) const;
+    void begin();
+    void loop();
+
+private:
+    RegImageData        _data = {};
+    SemaphoreHandle_t   _lock = nullptr;
+    QueueHandle_t       _writes = nullptr;
+    GpioPin             *_inputs[REGIMAGE_INPUTS] = {};
+    size_t              _inputCount = 0;
+    size_t              _curInput = 0;
+    MeteoSensor         *_sensors[REGIMAGE_SENSORS_MAX] = {};
+    size_t              _sensorCount = 0;
+
+    void _applyWrites();
+    void _refresh();
+    int16_t _tenths(float value) const;
+};
+
+extern RegImageClass RegImage;
+
+#endif /* __REG_IMAGE_HPP__ */
@@ -0,0 +1,59 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __RTC_STATE_HPP__
+#define __RTC_STATE_HPP__
+
+#include <Arduino.h>
+
+#define RTC_STATE_MAGIC     0x50434C52
+#define RTC_STATE_VERSION   1
+#define RTC_STATE_BSSID_LEN 6
+
+typedef struct {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    size;
+    uint32_t    sockets;
+    uint32_t    alarm;
+    float       brdTemp;
+    uint8_t     wifiChannel;
+    uint8_t     wifiBssid[RTC_STATE_BSSID_LEN];
+    bool        wifiValid;
+    uint32_t    crc;
+} RtcSnapshot;
+
+class RtcStateClass
+{
+public:
+    void begin();
+    bool isWarm() const;
+    void setSocket(size_t id, bool status);
+    bool getSocket(size_t id, bool &status) const;
+    void setAlarm(uint32_t alarm);
+    uint32_t getAlarm() const;
+    void setBoardTemp(float temp);
+    float getBoardTemp() const;
+    void setWiFi(uint8_t channel, const uint8_t *bssid);
+    bool getWiFi(uint8_t &channel, uint8_t *bssid) const;
+    void clearWiFi();
+
+private:
+    bool    _warm = false;
+
+    bool _isValid() const;
+    void _reset();
+    void _update();
+};
+
+extern RtcStateClass RtcState;
+
+#endif /* __RTC_STATE_HPP__ */
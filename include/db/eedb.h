@@ -15,16 +15,54 @@
 #include <Arduino.h>
 #include "I2C_eeprom.h"
 
+#include "core/ifaces/i2c.hpp"
+
 #define RR_DB_ID_MAX    64
 
+#define EE_DB_ADDR_SOCKET   0x0000
+#define EE_DB_ADDR_WIFI     0x0040
+#define EE_DB_ADDR_SMS      0x0080
+
+#define EE_DB_WIFI_MAGIC    0x57494649
+#define EE_DB_BSSID_LEN     6
+
+#define EE_DB_SMS_MAGIC     0x534D5351
+#define EE_DB_SMS_MAX       4
+#define EE_DB_PHONE_LEN     16
+#define EE_DB_SMS_TEXT_LEN  160
+
 typedef enum {
-    EE_DB_OFFSET_SOCKET
+    EE_DB_OFFSET_SOCKET,
+    EE_DB_OFFSET_WIFI,
+    EE_DB_OFFSET_SMS
 } EeDbOffset;
 
 typedef struct {
     uint64_t status;
 } EeDbSocket;
 
+typedef struct {
+    uint32_t    magic;
+    uint8_t     channel;
+    uint8_t     bssid[EE_DB_BSSID_LEN];
+    uint32_t    ip;
+    uint32_t    subnet;
+    uint32_t    gateway;
+    uint32_t    dns;
+} EeDbWiFi;
+
+typedef struct {
+    char        phone[EE_DB_PHONE_LEN];
+    char        text[EE_DB_SMS_TEXT_LEN + 1];
+    uint8_t     tries;
+} EeDbSmsMsg;
+
+typedef struct {
+    uint32_t    magic;
+    uint8_t     count;
+    EeDbSmsMsg  msgs[EE_DB_SMS_MAX];
+} EeDbSms;
+
 class EepromDbClass
 {
 public:
@@ -38,11 +76,20 @@ public:
     bool getSocketStatus(EeDbSocket &sockdb, uint8_t id, bool &status);
     bool setSocketStatus(EeDbSocket &sockdb, uint8_t id, bool status);
 
+    bool loadWiFiDb(EeDbWiFi &wifidb);
+    bool saveWiFiDb(EeDbWiFi &wifidb);
+
+    bool loadSmsDb(EeDbSms &smsdb);
+    bool saveSmsDb(EeDbSms &smsdb);
+
 private:
     bool _enabled = true;
     I2C_eeprom _ee;
+    I2cBus *_bus = nullptr;
+
+    void _account(bool ok);
 };
 
 extern EepromDbClass EeDb;
 
-#endif /* __EEPROM_DB_HPP__ */
\ No newline at end of file
+#endif /* __EEPROM_DB_HPP__ */
\ No newline at end of file
@@ -16,25 +16,131 @@
 #include "controllers/socket/socket.hpp"
 
 #include <Arduino.h>
+#include <memory>
 #include <WiFi.h>
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
 
+#include "net/apiwriter.hpp"
+
 #define API_SERVER_DEFAULT_PORT 8080
+#define API_CHUNK_ITEM_MAX      256
+#define API_CHUNK_NAME_MAX      (API_CHUNK_ITEM_MAX - 64)
+#define API_WS_CLIENTS_MAX      4
+#define API_WS_PERIOD_MS        100
+#define API_WS_MSG_MAX          2048
+#define API_BATCH_BODY_MAX      2048
+#define API_BATCH_OPS_MAX       SOCKET_COUNT
+#define API_BATCH_QUEUE_LEN     8
+
+typedef enum {
+    API_CHUNK_BEGIN,
+    API_CHUNK_ITEMS,
+    API_CHUNK_END
+} ApiChunkStage;
+
+typedef enum {
+    API_SOCKET_OFF,
+    API_SOCKET_ON,
+    API_SOCKET_SWITCH
+} ApiSocketOp;
+
+typedef enum {
+    API_METRIC_UPTIME,
+    API_METRIC_LOOPS,
+    API_METRIC_LOOP_TIME,
+    API_METRIC_HEAP,
+    API_METRIC_I2C_TRANSACTIONS,
+    API_METRIC_I2C_ERRORS,
+    API_METRIC_OW_READS,
+    API_METRIC_OW_FAILS,
+    API_METRIC_SOCKET_TOGGLES,
+    API_METRIC_WIFI_RSSI,
+    API_METRIC_WIFI_DROPS,
+    API_METRIC_WIFI_RECONNECTS,
+    API_METRIC_TG_LATENCY,
+    API_METRIC_MAX
+} ApiMetric;
+
+typedef struct {
+    ApiChunkStage   stage;
+    size_t          index;
+    size_t          count;
+    size_t          len;
+    size_t          pos;
+    uint32_t        version;
+    uint32_t        since;
+    uint32_t        boot;
+    char            item[API_CHUNK_ITEM_MAX];
+} ApiChunkState;
+
+typedef struct {
+    uint8_t     index;
+    uint8_t     op;
+} ApiSocketWrite;
+
+typedef struct {
+    uint32_t        id;
+    size_t          count;
+    ApiSocketWrite  ops[API_BATCH_OPS_MAX];
+} ApiBatch;
+
+typedef struct {
+    uint32_t    id;
+    bool        used;
+    bool        resync;
+} ApiWsClient;
+
+typedef struct {
+    unsigned    deltas;
+    unsigned    snapshots;
+    unsigned    skipped;
+    unsigned    rejected;
+} ApiWsStats;
 
 class APIServerClass : private AsyncWebServer
 {
 public:
-    APIServerClass(uint16_t port) : AsyncWebServer(port) {}
+    APIServerClass(uint16_t port) : AsyncWebServer(port), _ws("/ws") {}
     void setEnabled(bool status);
     bool getEnabled() const;
+    size_t getWsClients();
+    const ApiWsStats &getWsStats() const;
     void begin();
+    void loop();
 
 private:
-    bool    _enabled = true;
+    bool                _enabled = true;
+    AsyncWebSocket      _ws;
+    ApiWsClient         _wsClients[API_WS_CLIENTS_MAX];
+    SemaphoreHandle_t   _wsLock = nullptr;
+    ApiWsStats          _wsStats = { 0 };
+    uint32_t            _wsVersion = 0;
+    unsigned            _wsTimer = 0;
+    char                _wsDelta[API_WS_MSG_MAX];
+    char                _wsFull[API_WS_MSG_MAX];
+    QueueHandle_t       _batches = nullptr;
+    uint32_t            _batchId = 0;
+    volatile uint32_t   _batchApplied = 0;
+
     void    _socketHandler(Socket *sock, AsyncWebServerRequest *req, JsonDocument *out);
+    void    _gsmHandler(JsonDocument *out);
+    void    _batchBody(AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t index, size_t total);
+    void    _batchHandler(AsyncWebServerRequest *req, JsonDocument *out);
+    void    _batchStatus(AsyncWebServerRequest *req, JsonDocument *out);
+    bool    _batchQueue(ApiBatch &batch);
+    void    _batchApply();
+    void    _sendJson(AsyncWebServerRequest *req, JsonDocument &doc, int code = 200);
+    size_t  _sendChunk(ApiChunkState &state, uint8_t *buf, size_t maxLen, bool (APIServerClass::*next)(ApiChunkState &));
+    bool    _socketsNext(ApiChunkState &state);
+    bool    _metricsNext(ApiChunkState &state);
+    int     _metricsItem(ApiMetric metric, size_t &cursor, char *buf, size_t size);
     void    _sendError(JsonDocument *out, const String &msg);
+    void    _wsEvent(AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
+    void    _wsMark(size_t slot, uint32_t id, bool resync);
+    void    _wsFlush();
+    size_t  _wsState(char *buf, bool full, uint32_t version);
 };
 
 extern APIServerClass APIServer;
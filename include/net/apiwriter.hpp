@@ -0,0 +1,53 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __API_WRITER_HPP__
+#define __API_WRITER_HPP__
+
+#include <Arduino.h>
+
+/*
+ * Minimal JSON writer into a caller provided buffer. Nothing is
+ * allocated, output which does not fit sets the overflow flag.
+ */
+class ApiWriter
+{
+public:
+    ApiWriter(char *buf, size_t size);
+    void reset();
+    void beginObject(const char *key = nullptr);
+    void endObject();
+    void beginArray(const char *key = nullptr);
+    void endArray();
+    void add(const char *key, const char *value);
+    void add(const char *key, const char *value, size_t limit);
+    void add(const char *key, bool value);
+    void add(const char *key, long value);
+    void add(const char *key, float value, unsigned digits, size_t keyLimit = SIZE_MAX);
+    void comma();
+    size_t length() const;
+    bool overflow() const;
+    const char *c_str() const;
+
+private:
+    char    *_buf;
+    size_t  _size;
+    size_t  _len = 0;
+    bool    _overflow = false;
+    bool    _comma = false;
+
+    void _key(const char *key, size_t limit = SIZE_MAX);
+    void _char(char c);
+    void _raw(const char *str);
+    void _string(const char *str, size_t limit = SIZE_MAX);
+};
+
+#endif /* __API_WRITER_HPP__ */
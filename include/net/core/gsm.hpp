@@ -12,34 +12,221 @@
 #ifndef __GSM_HPP__
 #define __GSM_HPP__
 
-#define TINY_GSM_MODEM_SIM800
-
-#include <TinyGSM.h>
-#include <SoftwareSerial.h>
+#include <Arduino.h>
+#include <HardwareSerial.h>
+#include <functional>
+#include <vector>
 
 #include "core/ifaces/uart.hpp"
+#include "db/eedb.h"
 #include "utils/log.hpp"
 
-using namespace EspSoftwareSerial;
+#define GSM_UART_RX_BUF         1024
+#define GSM_AT_QUEUE_LEN        8
+#define GSM_AT_LINE_MAX         256
+#define GSM_AT_TIMEOUT_MS       1000
+#define GSM_AT_ESC_DELAY_MS     500
+#define GSM_STEP_DELAY_MS       1000
+#define GSM_POWER_DELAY_MS      3000
+#define GSM_RESET_DELAY_MS      10000
+#define GSM_SYNC_TIMEOUT_MS     10000
+#define GSM_SIM_TIMEOUT_MS      10000
+#define GSM_REG_TIMEOUT_MS      60000
+#define GSM_SIGNAL_TIMEOUT_MS   10000
+#define GSM_POLL_DELAY_MS       30000
+#define GSM_RETRY_DELAY_MS      60000
+
+#define GSM_SMS_EVENTS_MAX      8
+#define GSM_SMS_EVENT_LEN       64
+#define GSM_SMS_ALERTS_QUEUE    16
+#define GSM_SMS_WINDOW_MS       30000
+#define GSM_SMS_INTERVAL_MS     10000
+#define GSM_SMS_HOUR_MAX        20
+#define GSM_SMS_SEND_TIMEOUT_MS 60000
+#define GSM_SMS_RETRY_MIN_MS    30000
+#define GSM_SMS_RETRY_MAX_MS    1800000
+#define GSM_SMS_RETRY_COUNT     6
+#define GSM_SMS_UCS2_MAX        70
+
+typedef enum {
+    GSM_STATE_OFF,
+    GSM_STATE_POWER,
+    GSM_STATE_RESET,
+    GSM_STATE_AT_SYNC,
+    GSM_STATE_SIM,
+    GSM_STATE_REGISTRATION,
+    GSM_STATE_SIGNAL,
+    GSM_STATE_READY,
+    GSM_STATE_FAILED
+} GsmState;
+
+typedef enum {
+    GSM_REG_UNREGISTERED,
+    GSM_REG_OK_HOME,
+    GSM_REG_SEARCHING,
+    GSM_REG_DENIED,
+    GSM_REG_UNKNOWN,
+    GSM_REG_OK_ROAMING
+} GsmRegStatus;
+
+/*
+ * ok is false on ERROR, +CME/+CMS ERROR and timeout. resp holds the
+ * response lines without echo and final result, separated by '\n'.
+ */
+typedef std::function<void(bool ok, const String &resp)> GsmAtCallback;
+typedef std::function<void(const String &line)> GsmUrcCallback;
+
+typedef struct {
+    String          cmd;
+    String          payload;
+    unsigned        timeout;
+    GsmAtCallback   cb;
+} GsmAtCmd;
+
+typedef struct {
+    String          prefix;
+    GsmUrcCallback  cb;
+} GsmUrc;
+
+typedef struct {
+    unsigned    sent;
+    unsigned    failed;
+    unsigned    timeouts;
+    unsigned    dropped;
+    unsigned    urcs;
+    unsigned    rxBytes;
+} GsmAtStats;
+
+typedef struct {
+    String      phone;
+    String      text;
+    uint8_t     tries;
+    unsigned    next;
+} GsmSms;
+
+typedef struct {
+    char        text[GSM_SMS_EVENT_LEN];
+} GsmAlertMsg;
+
+typedef struct {
+    unsigned    queued;
+    unsigned    sent;
+    unsigned    failed;
+    unsigned    dropped;
+} GsmSmsStats;
 
 class GsmModemClass
 {
 private:
-    bool        _enabled = false;
-    UARTClass   *_uart;
+    bool                    _enabled = false;
+    UARTClass               *_uart;
 
-    UART        _gsmUart;
-    TinyGsm     *_modem;
+    HardwareSerial          *_gsmUart = nullptr;
+
+    GsmState                _state = GSM_STATE_OFF;
+    unsigned                _timerState = 0;
+    unsigned                _timerStep = 0;
+    bool                    _stepBusy = false;
+    GsmRegStatus            _regStatus = GSM_REG_UNKNOWN;
+    int                     _signal = 99;
+    String                  _operator;
+    String                  _imei;
+    String                  _ccid;
+    String                  _error;
+
+    std::vector<GsmAtCmd>   _queue;
+    std::vector<GsmUrc>     _urcs;
+    GsmAtCmd                _current;
+    bool                    _busy = false;
+    bool                    _prompt = false;
+    unsigned                _timerCmd = 0;
+    bool                    _escape = false;
+    unsigned                _timerEsc = 0;
+    String                  _line;
+    String                  _resp;
+    GsmAtStats              _atStats = { 0 };
+
+    std::vector<String>     _recipients;
+    std::vector<String>     _smsEvents;
+    QueueHandle_t           _alerts = nullptr;
+    std::vector<GsmSms>     _smsQueue;
+    bool                    _smsBusy = false;
+    unsigned                _timerCoalesce = 0;
+    unsigned                _timerSms = 0;
+    unsigned                _timerHour = 0;
+    unsigned                _smsHourCount = 0;
+    GsmSmsStats             _smsStats = { 0 };
+
+    void _setState(GsmState state);
+    void _fail(const String &error);
+    void _stepPower();
+    void _stepReset();
+    void _stepSync();
+    void _stepSim();
+    void _stepRegistration();
+    void _stepSignal();
+    void _stepReady();
+    bool _stepAT(const String &cmd, GsmAtCallback cb);
+
+    void _atRead();
+    void _atLine(const String &line);
+    void _atDone(bool ok);
+    void _atEscape();
+    bool _atUrc(const String &line);
+    void _parseStatus(const String &resp);
+    void _parseReg(const String &line);
+
+    void _smsLoop();
+    void _smsFlush();
+    void _smsSend(GsmSms &sms);
+    String _ucs2(const String &text, size_t max) const;
+    void _smsLoad();
+    void _smsSave();
 
-    String getRegStatus(const SIM800RegStatus state) const;
-    String getSigLevel(int level) const;
 public:
     GsmModemClass();
     void setUart(UARTClass *uart);
     UARTClass *getUart() const;
     void setEnabled(bool status);
     bool getEnabled() const;
+    GsmState getState() const;
+    String getStateName() const;
+    bool isReady() const;
+    GsmRegStatus getRegistration() const;
+    int getSignal() const;
+    const String &getOperator() const;
+    const String &getIMEI() const;
+    const String &getCCID() const;
+    const String &getError() const;
+    const GsmAtStats &getAtStats() const;
+    size_t getQueueSize() const;
+    String getRegStatus(const GsmRegStatus state) const;
+    String getSigLevel(int level) const;
+
+    /*
+     * Queue a command without the "AT" prefix, several commands may be
+     * joined with ';'. The payload is written after the '>' prompt and
+     * terminated with Ctrl+Z. Returns false if the queue is full.
+     */
+    bool sendAT(const String &cmd, GsmAtCallback cb = nullptr, unsigned timeout = GSM_AT_TIMEOUT_MS,
+                const String &payload = "");
+    void addUrc(const String &prefix, GsmUrcCallback cb);
+
+    void addRecipient(const String &phone);
+    void clearRecipients();
+    const std::vector<String> &getRecipients() const;
+
+    /*
+     * Events are collected for GSM_SMS_WINDOW_MS and sent as one SMS to
+     * every recipient. Duplicates within the window are dropped. Safe to
+     * call from any task, events are taken over by loop().
+     */
+    bool sendAlert(const String &text);
+    const GsmSmsStats &getSmsStats() const;
+    size_t getSmsQueueSize() const;
+
     void begin();
+    void loop();
 };
 
 extern GsmModemClass GsmModem;
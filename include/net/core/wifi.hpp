@@ -24,7 +24,45 @@
 #include <ESP8266WiFi.h>
 #endif
 
-#define WIFI_DELAY_MS   1000
+#define WIFI_FAST_TIMEOUT_MS    5000
+#define WIFI_CONNECT_TIMEOUT_MS 20000
+#define WIFI_BACKOFF_MIN_MS     500
+#define WIFI_BACKOFF_MAX_MS     60000
+#define WIFI_EVENTS_QUEUE_LEN   8
+
+typedef enum {
+    WIRELESS_STATE_IDLE,
+    WIRELESS_STATE_CONNECTING,
+    WIRELESS_STATE_ASSOCIATED,
+    WIRELESS_STATE_ONLINE,
+    WIRELESS_STATE_BACKOFF
+} WirelessState;
+
+typedef enum {
+    WIRELESS_EVT_CONNECTED,
+    WIRELESS_EVT_GOT_IP,
+    WIRELESS_EVT_LOST_IP,
+    WIRELESS_EVT_DISCONNECTED
+} WirelessEvtType;
+
+typedef struct {
+    WirelessEvtType type;
+    uint8_t         reason;
+    unsigned        time;
+} WirelessEvtMsg;
+
+typedef struct {
+    unsigned    fastCount;
+    unsigned    fullCount;
+    unsigned    fallbacks;
+    unsigned    fastTime;
+    unsigned    fullTime;
+    unsigned    lastTime;
+    bool        lastFast;
+    unsigned    drops;
+    unsigned    reconnects;
+    uint8_t     lastReason;
+} WiFiStats;
 
 class WirelessClass
 {
@@ -38,11 +76,18 @@ public:
     void setAP(bool status);
     bool &getAP();
     wl_status_t getStatus() const;
+    WirelessState getState() const;
     String getIP();
     void begin();
     void loop();
     void setHostname(const String &name);
     String getHostname();
+    void setFastConnect(bool status);
+    bool &getFastConnect();
+    void setStaticIP(const IPAddress &ip, const IPAddress &subnet, const IPAddress &gateway, const IPAddress &dns);
+    void clearStaticIP();
+    bool getStaticIP(IPAddress &ip, IPAddress &subnet, IPAddress &gateway, IPAddress &dns) const;
+    const WiFiStats &getStats() const;
 
 private:
     String      _ssid;
@@ -51,9 +96,31 @@ private:
     bool        _enabled = false;
     bool        _ap = true;
     wl_status_t _status = WL_NO_SHIELD;
-    unsigned    _timer = 0;
+    WirelessState _state = WIRELESS_STATE_IDLE;
+    bool        _fastConnect = true;
+    bool        _fastAttempt = false;
+    unsigned    _timerConnect = 0;
+    bool        _static = false;
+    IPAddress   _ip;
+    IPAddress   _subnet;
+    IPAddress   _gateway;
+    IPAddress   _dns;
+    WiFiStats   _stats = { 0 };
+    unsigned    _backoff = WIFI_BACKOFF_MIN_MS;
+    unsigned    _retryDelay = 0;
+    unsigned    _timerRetry = 0;
+    bool        _leaving = false;
+
+    QueueHandle_t   _events = nullptr;
+    wifi_event_id_t _eventId = 0;
 
-    void statusTask();
+    void _connect(bool fast);
+    void _saveCache();
+    void _onEvent(WiFiEvent_t event, WiFiEventInfo_t info);
+    void _processEvent(const WirelessEvtMsg &msg);
+    void _scheduleReconnect();
+    void _disconnect();
+    void _setOnline(bool online);
 };
 
 extern WirelessClass Wireless;
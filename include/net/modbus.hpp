@@ -0,0 +1,73 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __MODBUS_HPP__
+#define __MODBUS_HPP__
+
+#include <Arduino.h>
+
+#include "core/regimage.hpp"
+
+#define MODBUS_PDU_MAX          253
+#define MODBUS_READ_BITS_MAX    2000
+#define MODBUS_READ_REGS_MAX    125
+#define MODBUS_WRITE_BITS_MAX   1968
+#define MODBUS_WRITE_REGS_MAX   123
+
+typedef enum {
+    MODBUS_FC_READ_COILS        = 0x01,
+    MODBUS_FC_READ_INPUTS       = 0x02,
+    MODBUS_FC_READ_HOLDING      = 0x03,
+    MODBUS_FC_READ_IREGS        = 0x04,
+    MODBUS_FC_WRITE_COIL        = 0x05,
+    MODBUS_FC_WRITE_REG         = 0x06,
+    MODBUS_FC_WRITE_COILS       = 0x0F,
+    MODBUS_FC_WRITE_REGS        = 0x10
+} ModbusFunc;
+
+typedef enum {
+    MODBUS_EX_NONE              = 0x00,
+    MODBUS_EX_FUNCTION          = 0x01,
+    MODBUS_EX_ADDRESS           = 0x02,
+    MODBUS_EX_VALUE             = 0x03,
+    MODBUS_EX_FAILURE           = 0x04
+} ModbusException;
+
+typedef struct {
+    unsigned    requests;
+    unsigned    exceptions;
+    unsigned    writes;
+} ModbusStats;
+
+/*
+ * Modbus application layer shared by the TCP and RTU transports.
+ * Reads are served from the register image, writes are queued to
+ * the main loop through it.
+ */
+class ModbusClass
+{
+public:
+    size_t process(const uint8_t *req, size_t len, uint8_t *resp);
+    const ModbusStats &getStats() const;
+
+private:
+    ModbusStats _stats = { 0 };
+
+    ModbusException _readBits(const uint8_t *req, size_t len, uint8_t *resp, size_t &out);
+    ModbusException _readRegs(const uint8_t *req, size_t len, uint8_t *resp, size_t &out);
+    ModbusException _writeSingle(const uint8_t *req, size_t len, uint8_t *resp, size_t &out);
+    ModbusException _writeCoils(const uint8_t *req, size_t len, uint8_t *resp, size_t &out);
+    ModbusException _writeRegs(const uint8_t *req, size_t len, uint8_t *resp, size_t &out);
+};
+
+extern ModbusClass Modbus;
+
+#endif /* __MODBUS_HPP__ */
@@ -0,0 +1,73 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __MODBUS_RTU_HPP__
+#define __MODBUS_RTU_HPP__
+
+#include <Arduino.h>
+#include <HardwareSerial.h>
+
+#include "net/modbus.hpp"
+
+#define MODBUS_RTU_DEFAULT_ADDR 1
+#define MODBUS_RTU_FRAME_MAX    (1 + MODBUS_PDU_MAX + 2)
+#define MODBUS_RTU_RX_BUF       1024
+#define MODBUS_RTU_FAST_BAUD    19200
+#define MODBUS_RTU_FAST_T35_US  1750
+#define MODBUS_RTU_CHAR_BITS    10
+#define MODBUS_RTU_TOUT_MAX     100
+#define MODBUS_RTU_DE_NONE      -1
+
+typedef struct {
+    unsigned    frames;
+    unsigned    crcErrors;
+    unsigned    ignored;
+    unsigned    overruns;
+} ModbusRtuStats;
+
+/*
+ * Modbus RTU slave on the board UART. The UART driver assembles the
+ * frame and reports it after the 3.5 character silence.
+ */
+class ModbusRtuClass
+{
+public:
+    void setEnabled(bool status);
+    bool getEnabled() const;
+    void setAddress(uint8_t addr);
+    uint8_t getAddress() const;
+    void setDePin(int pin);
+    int getDePin() const;
+    bool isRunning() const;
+    unsigned getSpeed() const;
+    const ModbusRtuStats &getStats() const;
+    void begin();
+
+private:
+    bool            _enabled = false;
+    uint8_t         _addr = MODBUS_RTU_DEFAULT_ADDR;
+    int             _dePin = MODBUS_RTU_DE_NONE;
+    HardwareSerial  *_uart = nullptr;
+    unsigned        _speed = 0;
+    size_t          _len = 0;
+    bool            _overrun = false;
+    uint8_t         _frame[MODBUS_RTU_FRAME_MAX];
+    uint8_t         _resp[MODBUS_RTU_FRAME_MAX];
+    ModbusRtuStats  _stats = { 0 };
+
+    void _onReceive();
+    void _process();
+    uint16_t _crc(const uint8_t *buf, size_t len) const;
+};
+
+extern ModbusRtuClass ModbusRtu;
+
+#endif /* __MODBUS_RTU_HPP__ */
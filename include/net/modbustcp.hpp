@@ -0,0 +1,55 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __MODBUS_TCP_HPP__
+#define __MODBUS_TCP_HPP__
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+
+#include "net/modbus.hpp"
+
+#define MODBUS_TCP_DEFAULT_PORT 502
+#define MODBUS_TCP_CLIENTS_MAX  4
+#define MODBUS_TCP_MBAP_LEN     7
+#define MODBUS_TCP_FRAME_MAX    (MODBUS_TCP_MBAP_LEN + MODBUS_PDU_MAX)
+#define MODBUS_TCP_IDLE_S       60
+
+typedef struct {
+    AsyncClient *client;
+    size_t      len;
+    uint8_t     buf[MODBUS_TCP_FRAME_MAX];
+} ModbusTcpConn;
+
+class ModbusTcpClass
+{
+public:
+    ModbusTcpClass(uint16_t port) : _server(port) {}
+    void setEnabled(bool status);
+    bool getEnabled() const;
+    size_t getClients() const;
+    void begin();
+
+private:
+    bool            _enabled = false;
+    AsyncServer     _server;
+    ModbusTcpConn   _conns[MODBUS_TCP_CLIENTS_MAX] = {};
+    uint8_t         _resp[MODBUS_TCP_FRAME_MAX];
+
+    void _onClient(AsyncClient *client);
+    void _onData(ModbusTcpConn *conn, const uint8_t *data, size_t len);
+    void _onDisconnect(ModbusTcpConn *conn);
+    bool _frame(ModbusTcpConn *conn);
+};
+
+extern ModbusTcpClass ModbusTcp;
+
+#endif /* __MODBUS_TCP_HPP__ */
@@ -0,0 +1,115 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __MQTT_HPP__
+#define __MQTT_HPP__
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <PubSubClient.h>
+
+#define MQTT_DEFAULT_PORT       1883
+#define MQTT_DEFAULT_PERIOD_MS  10000
+#define MQTT_DEFAULT_PREFIX     F("fcplc")
+#define MQTT_QUEUE_SIZE         32
+#define MQTT_TOPIC_LEN          64
+#define MQTT_PAYLOAD_LEN        448
+#define MQTT_BUFFER_SIZE        576
+#define MQTT_SENSOR_NAME_MAX    32
+#define MQTT_SENSOR_ITEM_MAX    (MQTT_SENSOR_NAME_MAX + 16)
+#define MQTT_KEEPALIVE_S        30
+#define MQTT_TASK_STACK         6144
+#define MQTT_TASK_PRIO          1
+#define MQTT_TASK_DELAY_MS      10
+#define MQTT_WIFI_WAIT_MS       1000
+#define MQTT_RETRY_MIN_MS       2000
+#define MQTT_RETRY_MAX_MS       60000
+
+typedef struct {
+    uint32_t    seq;
+    bool        retain;
+    char        topic[MQTT_TOPIC_LEN];
+    char        payload[MQTT_PAYLOAD_LEN];
+} MqttMsg;
+
+typedef struct {
+    unsigned    connects;
+    unsigned    published;
+    unsigned    bytes;
+    unsigned    failed;
+    unsigned    dropped;
+    unsigned    commands;
+    unsigned    maxQueue;
+} MqttStats;
+
+/*
+ * MQTT publisher. Main loop only fills the outbound ring, the client
+ * runs in its own task and keeps messages queued while offline.
+ */
+class MqttClass
+{
+public:
+    MqttClass() : _client(_net) {}
+    void setEnabled(bool status);
+    bool getEnabled() const;
+    void setServer(const String &host, uint16_t port);
+    const String &getHost() const;
+    uint16_t getPort() const;
+    void setCreds(const String &user, const String &passwd);
+    const String &getUser() const;
+    const String &getPasswd() const;
+    void setPrefix(const String &prefix);
+    const String &getPrefix() const;
+    void setPeriod(unsigned period);
+    unsigned getPeriod() const;
+    bool isConnected() const;
+    size_t getQueueSize();
+    const MqttStats &getStats() const;
+    void begin();
+    void loop();
+
+private:
+    bool                _enabled = false;
+    String              _host;
+    uint16_t            _port = MQTT_DEFAULT_PORT;
+    String              _user;
+    String              _passwd;
+    String              _prefix = MQTT_DEFAULT_PREFIX;
+    unsigned            _period = MQTT_DEFAULT_PERIOD_MS;
+    WiFiClient          _net;
+    PubSubClient        _client;
+    TaskHandle_t        _task = nullptr;
+    SemaphoreHandle_t   _lock = nullptr;
+    MqttMsg             _queue[MQTT_QUEUE_SIZE];
+    size_t              _head = 0;
+    size_t              _count = 0;
+    uint32_t            _seq = 0;
+    volatile bool       _connected = false;
+    volatile bool       _resync = false;
+    uint32_t            _version = 0;
+    unsigned            _alarm = 0;
+    unsigned            _timerTelemetry = 0;
+    unsigned            _retryDelay = MQTT_RETRY_MIN_MS;
+    unsigned            _timerRetry = 0;
+    MqttStats           _stats = { 0 };
+
+    static void _taskHandler(void *arg);
+    bool _connect();
+    void _drain();
+    void _onMessage(char *topic, uint8_t *payload, unsigned len);
+    void _push(const char *suffix, const char *payload, bool retain);
+    void _publishState(bool full);
+    void _publishTelemetry();
+};
+
+extern MqttClass Mqtt;
+
+#endif /* __MQTT_HPP__ */
@@ -0,0 +1,139 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __REPLICA_HPP__
+#define __REPLICA_HPP__
+
+#include <Arduino.h>
+#include <AsyncUDP.h>
+
+#include "core/ifaces/gpio.hpp"
+#include "core/regimage.hpp"
+
+#define REPLICA_DEFAULT_GROUP   F("239.255.70.1")
+#define REPLICA_DEFAULT_PORT    5006
+#define REPLICA_DEFAULT_NODE    1
+#define REPLICA_MAGIC           0x504C4352
+#define REPLICA_PROTO           1
+#define REPLICA_PEERS_MAX       8
+#define REPLICA_MAP_MAX         16
+#define REPLICA_REPEAT_MS       20
+#define REPLICA_SYNC_MS         1000
+#define REPLICA_PEER_TIMEOUT_MS 3500
+
+typedef enum {
+    REPLICA_MSG_JOIN,
+    REPLICA_MSG_STATE
+} ReplicaMsgType;
+
+typedef enum {
+    REPLICA_SRC_INPUT,
+    REPLICA_SRC_SOCKET
+} ReplicaSource;
+
+/*
+ * Whole announced state fits in one datagram, so a delta is the new
+ * state sent at once and a lost one is repaired by the next sync.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t    magic;
+    uint8_t     proto;
+    uint8_t     type;
+    uint8_t     node;
+    uint8_t     reserved;
+    uint32_t    boot;
+    uint32_t    version;
+    uint32_t    coils;
+    uint32_t    sockets;
+    uint64_t    inputs;
+} ReplicaMsg;
+
+typedef struct {
+    uint8_t     node;
+    uint32_t    boot;
+    uint32_t    version;
+    uint32_t    coils;
+    uint32_t    sockets;
+    uint64_t    inputs;
+    IPAddress   ip;
+    unsigned    seen;
+    bool        online;
+} ReplicaPeer;
+
+typedef struct {
+    GpioPin         *pin;
+    uint8_t         node;
+    ReplicaSource   source;
+    uint8_t         index;
+} ReplicaMap;
+
+typedef struct {
+    unsigned    sent;
+    unsigned    received;
+    unsigned    applied;
+    unsigned    stale;
+    unsigned    joins;
+    unsigned    invalid;
+    unsigned    conflicts;
+    unsigned    overflows;
+} ReplicaStats;
+
+class ReplicaClass
+{
+public:
+    void setEnabled(bool status);
+    bool getEnabled() const;
+    void setNode(uint8_t node);
+    uint8_t getNode() const;
+    void setGroup(const IPAddress &ip, uint16_t port);
+    const IPAddress &getGroup() const;
+    uint16_t getPort() const;
+    void clearMap();
+    bool addMap(uint16_t pin, uint8_t node, ReplicaSource source, uint8_t index);
+    size_t getMapCount() const;
+    const ReplicaMap &getMap(size_t index) const;
+    size_t getPeers(ReplicaPeer *peers, size_t size);
+    uint32_t getVersion() const;
+    const ReplicaStats &getStats() const;
+    void begin();
+    void loop();
+
+private:
+    bool                _enabled = false;
+    uint8_t             _node = REPLICA_DEFAULT_NODE;
+    IPAddress           _group;
+    uint16_t            _port = REPLICA_DEFAULT_PORT;
+    bool                _running = false;
+    bool                _listening = false;
+    AsyncUDP            _udp;
+    SemaphoreHandle_t   _lock = nullptr;
+    ReplicaPeer         _peers[REPLICA_PEERS_MAX] = {};
+    ReplicaMap          _map[REPLICA_MAP_MAX] = {};
+    size_t              _mapCount = 0;
+    ReplicaMsg          _state = {};
+    volatile bool       _resync = false;
+    volatile bool       _dirty = false;
+    bool                _repeat = false;
+    unsigned            _timerRepeat = 0;
+    unsigned            _timerSync = 0;
+    ReplicaStats        _stats = { 0 };
+
+    void _listen();
+    bool _update();
+    void _send(ReplicaMsgType type);
+    void _onPacket(AsyncUDPPacket &packet);
+    bool _expire();
+    void _apply();
+};
+
+extern ReplicaClass Replica;
+
+#endif /* __REPLICA_HPP__ */
@@ -22,8 +22,44 @@
 #include <GyverHTTP.h>
 
 #include "utils/log.hpp"
+#include "net/tgclient.hpp"
 
-#define TG_USERS_COUNT  10
+#ifndef TG_USERS_COUNT
+#define TG_USERS_COUNT      10
+#endif
+
+/*
+ * Chat id index, the next power of two of twice TG_USERS_COUNT.
+ * Bits below the top one are smeared, indexes are 16 bit.
+ */
+#ifndef TG_USERS_HASH_SIZE
+#define TG_USERS_HASH_S0    (TG_USERS_COUNT * 2 - 1)
+#define TG_USERS_HASH_S1    (TG_USERS_HASH_S0 | (TG_USERS_HASH_S0 >> 1))
+#define TG_USERS_HASH_S2    (TG_USERS_HASH_S1 | (TG_USERS_HASH_S1 >> 2))
+#define TG_USERS_HASH_S3    (TG_USERS_HASH_S2 | (TG_USERS_HASH_S2 >> 4))
+#define TG_USERS_HASH_S4    (TG_USERS_HASH_S3 | (TG_USERS_HASH_S3 >> 8))
+#define TG_USERS_HASH_SIZE  (TG_USERS_HASH_S4 + 1)
+#endif
+
+#define TG_USERS_HASH_NONE  -1
+
+#define TG_TASK_STACK       12288
+#define TG_TASK_PRIO        1
+#define TG_TASK_DELAY_MS    50
+#define TG_WIFI_WAIT_MS     1000
+#define TG_CTRL_QUEUE_LEN   8
+
+#define TG_NOTIFY_QUEUE_LEN     16
+#define TG_NOTIFY_TEXT_LEN      48
+#define TG_NOTIFY_BATCH_MAX     16
+#define TG_NOTIFY_WINDOW_MS     5000
+#define TG_NOTIFY_LIST_MAX      3
+#define TG_NOTIFY_MSG_MAX       1024
+#define TG_NOTIFY_CHAT_MS       1000
+#define TG_NOTIFY_GLOBAL_MS     50
+#define TG_NOTIFY_RETRY_MS      5000
+#define TG_NOTIFY_RETRY_MAX_MS  300000
+#define TG_NOTIFY_RETRY_COUNT   5
 
 typedef enum {
     TG_MENU_MAIN,
@@ -40,6 +76,8 @@ typedef enum {
     TG_MENU_THERM
 } TgMenuLevel;
 
+#define TG_MENU_COUNT   (TG_MENU_THERM + 1)
+
 typedef struct {
     bool    read;
     bool    write;
@@ -47,7 +85,7 @@ typedef struct {
 
 typedef struct {
     String      name;
-    unsigned    chatId;
+    int64_t     chatId;
     bool        notify;
     bool        admin;
     TgMenuLevel level;
@@ -56,30 +94,138 @@ typedef struct {
     bool        enabled;
 } TgUser;
 
-class TgBotClass : public FastBot2
+typedef enum {
+    TG_CTRL_SOCKET
+} TgCtrlType;
+
+typedef struct {
+    TgCtrlType  type;
+    size_t      id;
+    bool        status;
+} TgCtrlMsg;
+
+typedef struct {
+    size_t      id;
+    String      name;
+    bool        status;
+} TgSocketState;
+
+typedef enum {
+    TG_NOTIFY_SOCKET,
+    TG_NOTIFY_ALARM,
+    TG_NOTIFY_TEXT
+} TgNotifyType;
+
+typedef struct {
+    TgNotifyType    type;
+    bool            status;
+    char            text[TG_NOTIFY_TEXT_LEN];
+} TgNotifyMsg;
+
+typedef struct {
+    String      text;
+    unsigned    next;
+    uint8_t     tries;
+} TgOutbox;
+
+typedef struct {
+    unsigned    queued;
+    unsigned    sent;
+    unsigned    failed;
+    unsigned    dropped;
+} TgNotifyStats;
+
+class TgBotClass : public FastBot2Client
 {
 public:
+    TgBotClass() : FastBot2Client(_client) { _buildIndex(); }
     void setEnabled(bool status);
     bool &getEnabled();
     bool setUser(size_t index, TgUser *user);
     bool getUser(const String &name, TgUser **user);
     bool getUser(size_t index, TgUser **user);
-    bool getUserByChatId(unsigned chatId, TgUser **user);
+    bool getUserByChatId(int64_t chatId, TgUser **user);
+    void updateUsers();
     std::array<TgUser, TG_USERS_COUNT> *getUsers();
     void getEnabledUsers(std::vector<TgUser *> &users);
-    unsigned getLastID() const;
+    int64_t getLastID() const;
     bool isUserExists(const String &name) const;
+
+    /*
+     * Events are coalesced for TG_NOTIFY_WINDOW_MS and sent as one
+     * message to every user with the notify flag. Safe from any task.
+     */
+    bool notify(TgNotifyType type, const String &text, bool status = false);
+    const TgNotifyStats &getNotifyStats() const;
+    const TgClientStats &getClientStats() const;
+
+    /*
+     * Drop cached keyboards after the socket or controller set changed
+     */
+    void invalidateMenus();
+
+    /*
+     * Bot settings and users are shared with the bot task. Setters
+     * below take the bot lock, direct edits of a TgUser must be made
+     * between lock() and unlock().
+     */
+    void setToken(const String &token);
+    void setPollMode(fb::Poll mode, uint16_t period);
+    void setProxy(const char *host, uint16_t port);
+    void lock();
+    void unlock();
     void begin();
     void loop();
 
 private:
+    TgClient                            _client;
     std::array<TgUser, TG_USERS_COUNT>  _users;
     bool                                _enabled = false;
-    unsigned                            _lastID = 0;
+    int64_t                             _lastID = 0;
+    int16_t                             _usersIndex[TG_USERS_HASH_SIZE];
+
+    TaskHandle_t                        _task = nullptr;
+    QueueHandle_t                       _ctrlQueue = nullptr;
+    SemaphoreHandle_t                   _botLock = nullptr;
+    SemaphoreHandle_t                   _sockLock = nullptr;
+    std::vector<TgSocketState>          _sockStates;
+    uint32_t                            _sockMask = 0;
+    size_t                              _sockCount = 0;
+    unsigned                            _sockVersion = 0;
+
+    std::array<fb::Menu, TG_MENU_COUNT> _menus;
+    bool                                _menuValid[TG_MENU_COUNT] = { false };
+    fb::InlineMenu                      _sockMenu;
+    bool                                _sockMenuValid = false;
+    unsigned                            _menuSockVersion = 0;
+    volatile bool                       _menusDirty = false;
+
+    QueueHandle_t                       _notifyQueue = nullptr;
+    std::vector<TgNotifyMsg>            _notifyBatch;
+    unsigned                            _notifyOverflow = 0;
+    unsigned                            _timerNotify = 0;
+    unsigned                            _timerSend = 0;
+    std::array<TgOutbox, TG_USERS_COUNT> _outbox;
+    TgNotifyStats                       _notifyStats = { 0 };
+
+    static void _taskHandler(void *arg);
+    bool _control(const TgCtrlMsg &msg);
+    void _applyControl(const TgCtrlMsg &msg);
+    void _updateSockets();
+    void _getSockets(std::vector<TgSocketState> &socks, unsigned &version);
+    fb::Menu &_getMenu(TgMenuLevel level);
+    fb::InlineMenu &_getSocketsMenu(const std::vector<TgSocketState> &socks, unsigned version);
+    String _socketsText(const std::vector<TgSocketState> &socks);
+    void _notifyLoop(bool online);
+    void _notifyFlush();
+    void _notifySend();
+    size_t _hashChatId(int64_t chatId) const;
+    void _buildIndex();
 
     void _backMenu(TgUser *user);
     bool _processLevel(TgUser *user, const String &msg);
     void _updateHandler(fb::Update& upd);
+    void _queryHandler(fb::Update& upd);
 
     bool _mainHandler(TgUser *user, const String &msg);
     bool _meteoHandler(TgUser *user, const String &msg);
@@ -92,6 +238,10 @@ private:
     bool _thermsHandler(TgUser *user, const String &msg);
 };
 
+static_assert((TG_USERS_HASH_SIZE & (TG_USERS_HASH_SIZE - 1)) == 0, "TG_USERS_HASH_SIZE must be a power of two");
+static_assert(TG_USERS_HASH_SIZE >= TG_USERS_COUNT * 2, "TG_USERS_HASH_SIZE is too small for TG_USERS_COUNT");
+static_assert(TG_USERS_HASH_SIZE <= 32768, "TG_USERS_COUNT is too large for the 16 bit index");
+
 extern TgBotClass TgBot;
 
 #endif /* __TG_BOT_HPP__ */
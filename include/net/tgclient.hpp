@@ -0,0 +1,86 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __TG_CLIENT_HPP__
+#define __TG_CLIENT_HPP__
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+
+#define TG_CLIENT_DNS_TTL_MS    600000
+#define TG_CLIENT_HOST_LEN      64
+#define TG_CLIENT_LINE_LEN      64
+
+typedef enum {
+    TG_HTTP_IDLE,
+    TG_HTTP_HEADERS,
+    TG_HTTP_BODY,
+    TG_HTTP_CHUNK_SIZE,
+    TG_HTTP_CHUNK_DATA,
+    TG_HTTP_CHUNK_END,
+    TG_HTTP_TRAILER,
+    TG_HTTP_DONE
+} TgHttpState;
+
+typedef struct {
+    unsigned    handshakes;
+    unsigned    reuses;
+    unsigned    dnsLookups;
+    unsigned    requests;
+    unsigned    lastHandshake;
+    unsigned    lastLatency;
+    unsigned    totalLatency;
+} TgClientStats;
+
+/*
+ * TLS client for the Telegram API which keeps the connection open
+ * between requests and caches the resolved address of the host. The
+ * response is followed as it is read, the session is only kept when
+ * it was read to the end.
+ */
+class TgClient : public WiFiClientSecure
+{
+public:
+    TgClient();
+    int connect(const char *host, uint16_t port) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buf, size_t size) override;
+    void stop() override;
+    void close();
+    const TgClientStats &getStats() const;
+
+private:
+    char            _host[TG_CLIENT_HOST_LEN] = { 0 };
+    uint16_t        _port = 0;
+    char            _dnsHost[TG_CLIENT_HOST_LEN] = { 0 };
+    IPAddress       _ip;
+    unsigned        _timerDns = 0;
+    unsigned        _timerReq = 0;
+    bool            _waiting = false;
+    TgHttpState     _http = TG_HTTP_IDLE;
+    char            _line[TG_CLIENT_LINE_LEN];
+    size_t          _lineLen = 0;
+    size_t          _remain = 0;
+    bool            _hasLength = false;
+    bool            _chunked = false;
+    bool            _keepAlive = true;
+    TgClientStats   _stats = { 0 };
+
+    bool _resolve(const char *host);
+    void _begin();
+    void _feed(const uint8_t *data, size_t len);
+    void _header();
+    void _lineDone();
+};
+
+#endif /* __TG_CLIENT_HPP__ */
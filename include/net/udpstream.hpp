@@ -0,0 +1,76 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __UDP_STREAM_HPP__
+#define __UDP_STREAM_HPP__
+
+#include <Arduino.h>
+#include <AsyncUDP.h>
+
+#include "core/regimage.hpp"
+
+#define UDP_STREAM_DEFAULT_PORT 5005
+#define UDP_STREAM_DEFAULT_RATE 10
+#define UDP_STREAM_RATE_MAX     50
+#define UDP_STREAM_MAGIC        0x55504346
+#define UDP_STREAM_VERSION      1
+
+/*
+ * Fixed layout telemetry frame, little endian. Any change of the
+ * layout must bump UDP_STREAM_VERSION and tools/udpdecode.py.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t        magic;
+    uint16_t        version;
+    uint16_t        size;
+    uint32_t        seq;
+    uint32_t        time;
+    RegImageData    image;
+} UdpFrame;
+
+typedef struct {
+    unsigned    sent;
+    unsigned    failed;
+    unsigned    late;
+} UdpStreamStats;
+
+class UdpStreamClass
+{
+public:
+    void setEnabled(bool status);
+    bool getEnabled() const;
+    void setTarget(const IPAddress &ip, uint16_t port);
+    const IPAddress &getIP() const;
+    uint16_t getPort() const;
+    void setRate(unsigned rate);
+    unsigned getRate() const;
+    const UdpStreamStats &getStats() const;
+    void begin();
+    void loop();
+
+private:
+    bool            _enabled = false;
+    IPAddress       _ip;
+    uint16_t        _port = UDP_STREAM_DEFAULT_PORT;
+    unsigned        _rate = UDP_STREAM_DEFAULT_RATE;
+    unsigned        _period = 0;
+    unsigned        _next = 0;
+    bool            _running = false;
+    AsyncUDP        _udp;
+    UdpFrame        _frame;
+    UdpStreamStats  _stats = { 0 };
+
+    void _send();
+};
+
+extern UdpStreamClass UdpStream;
+
+#endif /* __UDP_STREAM_HPP__ */
@@ -85,7 +85,7 @@ private:
         bool        Enabled;
         bool        Admin;
         bool        Notify;
-        unsigned    ChatID;
+        int64_t     ChatID;
     } _tgUser;
 
     struct {
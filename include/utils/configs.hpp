@@ -32,6 +32,7 @@ class ConfigsClass
 {
 public:
     bool begin();
+    bool mount();
     bool writeAll();
     bool eraseAll();
     bool showStartup();
@@ -41,6 +42,7 @@ public:
 
 private:
     ConfigsSource _src;
+    bool          _mounted = false;
 
     bool _initDevice();
     bool _readAll(ConfigsSource src);
@@ -11,6 +11,8 @@
 
 #include "controllers/meteo/meteo.hpp"
 #include "controllers/meteo/sensors/ds18b20.hpp"
+#include "core/plc.hpp"
+#include "core/regimage.hpp"
 
 /*********************************************************************/
 /*                                                                   */
@@ -50,6 +52,7 @@ void MeteoCtrl::addSensor(MeteoSensor *sensor)
         auto *s = static_cast<Ds18b20 *>(sensor);
         s->setDSBus(&_ds);
         _sensors.push_back(s);
+        RegImage.addSensor(s);
         Log.info(F("METEO"), String(F("Add sensor name: ")) +
                                 sensor->getName() +
                                 String(F(" type: DS18B20")));
@@ -96,7 +99,16 @@ void MeteoCtrl::loop()
     }
 
     if (_ready) {
-        _sensors[_curSensor]->readData();
+        MeteoSensor *sensor = _sensors[_curSensor];
+        float temp = sensor->getTemperature();
+        float hum = sensor->getHumidity();
+        float pres = sensor->getPressure();
+
+        sensor->readData();
+        if (temp != sensor->getTemperature() || hum != sensor->getHumidity() ||
+                pres != sensor->getPressure()) {
+            Plc.updateVersion();
+        }
         if (_curSensor < (_sensors.size() - 1)) {
             _curSensor++;
         } else {
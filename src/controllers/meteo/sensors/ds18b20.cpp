@@ -11,6 +11,7 @@
 
 #include "controllers/meteo/meteo.hpp"
 #include "controllers/meteo/sensors/ds18b20.hpp"
+#include "core/metrics.hpp"
 
 /*********************************************************************/
 /*                                                                   */
@@ -61,7 +62,10 @@ void Ds18b20::readData()
     if (!_enabled || _ds == nullptr) return;
 
     if (_ds->ready()) {
-        if (_ds->readTemp(_id)) {
+        bool ok = _ds->readTemp(_id);
+
+        Metrics.owRead(_id, ok);
+        if (ok) {
             _error = 0;
             _errorNotify = false;
             _temp = _ds->getTemp();
@@ -13,6 +13,10 @@
 #include "db/socketdb.hpp"
 #include "StringUtils.h"
 #include "db/eedb.h"
+#include "core/rtcstate.hpp"
+#include "net/core/gsm.hpp"
+#include "net/tgbot.hpp"
+#include "core/plc.hpp"
 
 /*********************************************************************/
 /*                                                                   */
@@ -49,6 +53,8 @@ bool SocketCtrlClass::setSocket(uint8_t index, Socket *sock)
     }
 
     memcpy(&_sockets[index], sock, sizeof(Socket));
+    _sockets[index].version = Plc.updateVersion();
+    TgBot.invalidateMenus();
 
     return true;
 }
@@ -128,6 +134,10 @@ void SocketCtrlClass::loop()
 
 void SocketCtrlClass::setStatus(Socket *sock, bool status, bool save)
 {
+    if (sock->status != status) {
+        sock->version = Plc.updateVersion();
+        sock->toggles++;
+    }
     sock->status = status;
 
     Log.info(F("SOCKET"), String(F("Socket ")) + sock->name + String(F(" changed status to ")) + (sock->status ? "ON" : "OFF"));
@@ -136,37 +146,58 @@ void SocketCtrlClass::setStatus(Socket *sock, bool status, bool save)
         Gpio.write(sock->relay, status);
     }
 
+    RtcState.setSocket(sock->id, status);
+
     if (save) {
-        if (EeDb.getEnabled()) {
-            EeDbSocket  db;
-            if (EeDb.loadSocketDb(db)) {
-                if (EeDb.setSocketStatus(db, sock->id, status)) {
-                    if (EeDb.saveSocketDb(db)) {
-                        Log.info(F("SOCKET"), String(F("Socket status saved to EEPROM. Id: ")) + String(sock->id));
-                    } else {
-                        Log.error(F("SOCKET"), String(F("Failed to save socket status to EEPROM. Id: ")) + String(sock->id));
-                    }
-                } else {
-                    Log.error(F("SOCKET"), String(F("Failed to set socket status to EEPROM. Id: ")) + String(sock->id));
-                }
-            } else {
-                Log.error(F("SOCKET"), String(F("Failed to load socket status from EEPROM. Id: ")) + String(sock->id));
-            }
+        GsmModem.sendAlert(sock->name + (status ? F(" ON") : F(" OFF")));
+        TgBot.notify(TG_NOTIFY_SOCKET, sock->name, status);
+
+        if (_batch) {
+            _batchMask |= (1UL << (sock - _sockets.data()));
         } else {
-            SocketDB    db;
-            db.loadFromFile(F("socket.json"));
-            db.close();
-            db.setStatus(sock->name, status);
-            db.saveToFile();
-            db.close();
-            db.clear();
+            _saveStates(1UL << (sock - _sockets.data()));
         }
     }
 }
 
+void SocketCtrlClass::beginBatch()
+{
+    _batch = true;
+    _batchMask = 0;
+    Gpio.beginBatch();
+}
+
+void SocketCtrlClass::commitBatch()
+{
+    /*
+     * Relays of the batch are committed together and the statuses
+     * are persisted with a single storage write.
+     */
+
+    Gpio.commit();
+    _batch = false;
+
+    if (_batchMask != 0) {
+        _saveStates(_batchMask);
+        _batchMask = 0;
+    }
+}
+
 bool SocketCtrlClass::loadStates()
 {
-    if (EeDb.getEnabled()) {
+    if (RtcState.isWarm()) {
+        bool    status;
+
+        for (size_t i = 0; i < _sockets.size(); i++) {
+            if (!_sockets[i].enabled) {
+                continue;
+            }
+            if (RtcState.getSocket(_sockets[i].id, status)) {
+                setStatus(&_sockets[i], status, false);
+            }
+        }
+        Log.info(F("SOCKET"), F("Socket statuses restored from RTC memory"));
+    } else if (EeDb.getEnabled()) {
         EeDbSocket  db;
         bool        status;
 
@@ -217,6 +248,44 @@ bool &SocketCtrlClass::getStatus(Socket *sock)
 /*                                                                   */
 /*********************************************************************/
 
+void SocketCtrlClass::_saveStates(uint32_t mask)
+{
+    if (EeDb.getEnabled()) {
+        EeDbSocket  db;
+
+        if (!EeDb.loadSocketDb(db)) {
+            Log.error(F("SOCKET"), F("Failed to load socket status from EEPROM"));
+            return;
+        }
+        for (size_t i = 0; i < _sockets.size(); i++) {
+            if (!(mask & (1UL << i))) {
+                continue;
+            }
+            if (!EeDb.setSocketStatus(db, _sockets[i].id, _sockets[i].status)) {
+                Log.error(F("SOCKET"), String(F("Failed to set socket status to EEPROM. Id: ")) + String(_sockets[i].id));
+            }
+        }
+        if (EeDb.saveSocketDb(db)) {
+            Log.info(F("SOCKET"), String(F("Socket status saved to EEPROM. Mask: 0x")) + String(mask, HEX));
+        } else {
+            Log.error(F("SOCKET"), String(F("Failed to save socket status to EEPROM. Mask: 0x")) + String(mask, HEX));
+        }
+    } else {
+        SocketDB    db;
+
+        db.loadFromFile(F("socket.json"));
+        db.close();
+        for (size_t i = 0; i < _sockets.size(); i++) {
+            if (mask & (1UL << i)) {
+                db.setStatus(_sockets[i].name, _sockets[i].status);
+            }
+        }
+        db.saveToFile();
+        db.close();
+        db.clear();
+    }
+}
+
 void SocketCtrlClass::_loopSocket(Socket *sock)
 {
     if (sock->reading) {
@@ -0,0 +1,182 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "core/boot.hpp"
+#include "utils/log.hpp"
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+void BootClass::begin()
+{
+    for (size_t i = 0; i < _stages.size(); i++) {
+        _stages[i].enabled = false;
+        _stages[i].status = BOOT_STATUS_WAIT;
+    }
+    _outputs = 0;
+    _total = 0;
+    _finished = false;
+    _start = micros();
+}
+
+bool BootClass::addStage(BootStageId id, const String &name, BootFunc func, uint32_t deps, bool async)
+{
+    if (id >= BOOT_STAGE_MAX) {
+        return false;
+    }
+
+    _stages[id].name = name;
+    _stages[id].func = func;
+    _stages[id].deps = deps;
+    _stages[id].async = async;
+    _stages[id].enabled = true;
+    _stages[id].status = BOOT_STATUS_WAIT;
+    _stages[id].start = 0;
+    _stages[id].duration = 0;
+
+    return true;
+}
+
+void BootClass::run()
+{
+    uint32_t all = 0;
+
+    _events = xEventGroupCreate();
+    if (_events == nullptr) {
+        Log.error(F("BOOT"), F("Failed to create boot events"));
+        return;
+    }
+
+    /*
+     * Disabled stages count as finished so nothing waits on them
+     */
+
+    for (size_t i = 0; i < _stages.size(); i++) {
+        all |= BOOT_DEP(i);
+        if (!_stages[i].enabled) {
+            xEventGroupSetBits(_events, BOOT_DEP(i));
+        }
+    }
+
+    /*
+     * Async stages are started first, each one waits for its own
+     * dependencies, so sync stages may depend on them in any order.
+     */
+
+    for (size_t i = 0; i < _stages.size(); i++) {
+        if (!_stages[i].enabled || !_stages[i].async) {
+            continue;
+        }
+        if (xTaskCreate(_stageTask, _stages[i].name.c_str(), BOOT_TASK_STACK,
+                        &_stages[i], BOOT_TASK_PRIO, nullptr) != pdPASS) {
+            Log.warning(F("BOOT"), String(F("Failed to start task for stage ")) + _stages[i].name);
+            _stages[i].async = false;
+        }
+    }
+
+    for (size_t i = 0; i < _stages.size(); i++) {
+        if (_stages[i].enabled && !_stages[i].async) {
+            _runStage(&_stages[i]);
+        }
+    }
+
+    xEventGroupWaitBits(_events, all, pdFALSE, pdTRUE, portMAX_DELAY);
+    vEventGroupDelete(_events);
+    _events = nullptr;
+
+    _total = micros();
+    _finished = true;
+    Log.info(F("BOOT"), String(F("Controller started in ")) + String((_total - _start) / 1000) + String(F(" ms")));
+}
+
+void BootClass::setOutputsValid()
+{
+    _outputs = micros();
+    Log.info(F("BOOT"), String(F("Outputs valid after ")) + String((_outputs - _start) / 1000) + String(F(" ms")));
+}
+
+bool BootClass::getStage(size_t index, BootStage **stage)
+{
+    if (index >= _stages.size() || !_stages[index].enabled) {
+        return false;
+    }
+    *stage = &_stages[index];
+    return true;
+}
+
+size_t BootClass::getStagesCount() const
+{
+    return _stages.size();
+}
+
+unsigned BootClass::getOutputsTime() const
+{
+    return (_outputs == 0) ? 0 : _outputs - _start;
+}
+
+unsigned BootClass::getTotalTime() const
+{
+    return _total - _start;
+}
+
+bool BootClass::isFinished() const
+{
+    return _finished;
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void BootClass::_runStage(BootStage *stage)
+{
+    size_t id = stage - &_stages[0];
+
+    if (stage->deps != 0) {
+        xEventGroupWaitBits(_events, stage->deps, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    for (size_t i = 0; i < _stages.size(); i++) {
+        if ((stage->deps & BOOT_DEP(i)) && (_stages[i].status == BOOT_STATUS_FAILED ||
+                                            _stages[i].status == BOOT_STATUS_SKIPPED)) {
+            stage->status = BOOT_STATUS_SKIPPED;
+            Log.warning(F("BOOT"), String(F("Stage ")) + stage->name + String(F(" skipped")));
+            xEventGroupSetBits(_events, BOOT_DEP(id));
+            return;
+        }
+    }
+
+    stage->status = BOOT_STATUS_RUN;
+    stage->start = micros() - _start;
+    stage->status = stage->func() ? BOOT_STATUS_DONE : BOOT_STATUS_FAILED;
+    stage->duration = micros() - _start - stage->start;
+
+    if (stage->status == BOOT_STATUS_FAILED) {
+        Log.error(F("BOOT"), String(F("Stage ")) + stage->name + String(F(" failed")));
+    }
+
+    xEventGroupSetBits(_events, BOOT_DEP(id));
+}
+
+void BootClass::_stageTask(void *arg)
+{
+    auto *stage = static_cast<BootStage *>(arg);
+
+    Boot._runStage(stage);
+    vTaskDelete(nullptr);
+}
+
+BootClass Boot;
@@ -33,6 +33,9 @@ bool CLIConfiguratorClass::configWiFi(const String &cmd)
         Serial.println(F("\tssid <ssid>         : Setup WiFi SSID name"));
         Serial.println(F("\tpasswd <passwd>     : Setup WiFi password"));
         Serial.println(F("\tap <on/off>         : Setup Access Point status"));
+        Serial.println(F("\tfast <on/off>       : Reuse cached AP and lease on connect"));
+        Serial.println(F("\tip <ip> <mask> <gw> : Setup static IP address"));
+        Serial.println(F("\tno ip               : Use DHCP"));
         Serial.println(F("\tshutdown            : Disable Wi-Fi"));
         Serial.println(F("\tno shutdown         : Enable Wi-Fi"));
         Serial.println(F("\texit                : Exit from WiFi configuration\n"));
@@ -73,6 +76,37 @@ bool CLIConfiguratorClass::configWiFi(const String &cmd)
             return false;
         }
 
+        return true;
+    } else if (cmd.indexOf(F("fast ")) >= 0) {
+        String value(cmd);
+
+        value.remove(0, 5);
+        if (value == "on") {
+            Wireless.setFastConnect(true);
+        } else if (value == "off") {
+            Wireless.setFastConnect(false);
+        } else {
+            return false;
+        }
+
+        return true;
+    } else if (cmd == "no ip") {
+        Wireless.clearStaticIP();
+        return true;
+    } else if (cmd.indexOf(F("ip ")) == 0) {
+        std::vector<String> args;
+        IPAddress           ip, subnet, gateway;
+        String              value(cmd);
+
+        value.remove(0, 3);
+        if (!Utils.splitString(value, " ", args) || args.size() != 3) {
+            return false;
+        }
+        if (!ip.fromString(args[0]) || !subnet.fromString(args[1]) || !gateway.fromString(args[2])) {
+            return false;
+        }
+        Wireless.setStaticIP(ip, subnet, gateway, gateway);
+
         return true;
     }
 
@@ -176,40 +210,43 @@ bool CLIConfiguratorClass::configTgBotUser(const String &userName, const String
         String value(cmd);
 
         value.remove(0, 5);
+        TgBot.lock();
         user->name = value;
+        TgBot.unlock();
 
         return true;
     } else if (cmd.indexOf(F("admin ")) >= 0) {
         String value(cmd);
 
         value.remove(0, 6);
-        if (value == "true") {
-            user->admin = true;
-        } else if (value == "false") {
-            user->admin = false;
-        } else {
+        if (value != "true" && value != "false") {
             return false;
         }
+        TgBot.lock();
+        user->admin = (value == "true");
+        TgBot.unlock();
 
         return true;
     } else if (cmd.indexOf(F("id ")) >= 0) {
         String value(cmd);
 
         value.remove(0, 3);
-        user->chatId = value.toInt();
+        TgBot.lock();
+        user->chatId = strtoll(value.c_str(), nullptr, 10);
+        TgBot.updateUsers();
+        TgBot.unlock();
 
         return true;
     } else if (cmd.indexOf(F("notify ")) >= 0) {
         String value(cmd);
 
         value.remove(0, 7);
-        if (value == "on") {
-            user->notify = true;
-        } else if (value == "off") {
-            user->notify = false;
-        } else {
+        if (value != "on" && value != "off") {
             return false;
         }
+        TgBot.lock();
+        user->notify = (value == "on");
+        TgBot.unlock();
 
         return true;
     }
@@ -110,6 +110,20 @@ bool CLIProcessorClass::_parseEnableCmd(const String &cmd)
         CLIInformer.showTgBot();
     } else if (cmd == "show i2c") {
         CLIInformer.showI2C();
+    } else if (cmd == "show boot") {
+        CLIInformer.showBoot();
+    } else if (cmd == "show gsm") {
+        CLIInformer.showGsm();
+    } else if (cmd == "show api") {
+        CLIInformer.showApi();
+    } else if (cmd == "show modbus") {
+        CLIInformer.showModbus();
+    } else if (cmd == "show mqtt") {
+        CLIInformer.showMqtt();
+    } else if (cmd == "show udp") {
+        CLIInformer.showUdp();
+    } else if (cmd == "show replica") {
+        CLIInformer.showReplica();
     } else if (cmd == "show meteo status") {
         CLIInformer.showMeteoStatus();
     } else if (cmd == "ftest") {
@@ -149,6 +163,13 @@ bool CLIProcessorClass::_parseEnableCmd(const String &cmd)
         Serial.println(F("\tshow ext                : I2C extenders configurations"));
         Serial.println(F("\tshow ow                 : Print OneWire devices on bus"));
         Serial.println(F("\tshow i2c                : Print I2C devices on bus"));
+        Serial.println(F("\tshow boot               : Boot stages timings"));
+        Serial.println(F("\tshow gsm                : GSM modem status"));
+        Serial.println(F("\tshow api                : API server status"));
+        Serial.println(F("\tshow modbus             : Modbus server status"));
+        Serial.println(F("\tshow mqtt               : MQTT client status"));
+        Serial.println(F("\tshow udp                : UDP telemetry status"));
+        Serial.println(F("\tshow replica            : PLC replication status"));
         Serial.println(F("\tshow startup            : Print configs saved to flash"));
         Serial.println(F("\tshow running            : Print configs from RAM"));
         Serial.println(F("\treload                  : Reboot device"));
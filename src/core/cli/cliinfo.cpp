@@ -20,6 +20,16 @@
 #include "controllers/meteo/meteo.hpp"
 #include "controllers/meteo/sensors/ds18b20.hpp"
 #include "net/tgbot.hpp"
+#include "core/boot.hpp"
+#include "core/rtcstate.hpp"
+#include "net/core/gsm.hpp"
+#include "net/apiserver.hpp"
+#include "net/modbustcp.hpp"
+#include "net/modbusrtu.hpp"
+#include "net/mqtt.hpp"
+#include "net/udpstream.hpp"
+#include "net/replica.hpp"
+#include "core/plc.hpp"
 
 void CLIInformerClass::showWiFi()
 {
@@ -27,7 +37,18 @@ void CLIInformerClass::showWiFi()
     Serial.printf("\tStatus     : %s\n", (Wireless.getEnabled() == true) ? F("Enabled") : F("Disabled"));
     Serial.printf("\tSSID       : %s\n", Wireless.getSSID().c_str());
     Serial.printf("\tPassword   : %s\n", Wireless.getPasswd().c_str());
-    Serial.printf("\tAP         : %s\n\n", (Wireless.getAP() == true) ? "on" : "off");
+    Serial.printf("\tAP         : %s\n", (Wireless.getAP() == true) ? "on" : "off");
+    Serial.printf("\tFast       : %s\n", (Wireless.getFastConnect() == true) ? "on" : "off");
+
+    IPAddress ip, subnet, gateway, dns;
+    if (Wireless.getStaticIP(ip, subnet, gateway, dns)) {
+        Serial.printf("\tStatic IP  : %s\n", ip.toString().c_str());
+        Serial.printf("\tSubnet     : %s\n", subnet.toString().c_str());
+        Serial.printf("\tGateway    : %s\n", gateway.toString().c_str());
+        Serial.printf("\tDNS        : %s\n\n", dns.toString().c_str());
+    } else {
+        Serial.println(F("\tStatic IP  : DHCP\n"));
+    }
 }
 
 void CLIInformerClass::showWiFiStatus()
@@ -79,9 +100,47 @@ void CLIInformerClass::showWiFiStatus()
         }
     }
 
+    String wifiState = F("Idle");
+
+    switch (Wireless.getState())
+    {
+        case WIRELESS_STATE_CONNECTING:
+            wifiState = F("Connecting");
+            break;
+
+        case WIRELESS_STATE_ASSOCIATED:
+            wifiState = F("Associated");
+            break;
+
+        case WIRELESS_STATE_ONLINE:
+            wifiState = F("Online");
+            break;
+
+        case WIRELESS_STATE_BACKOFF:
+            wifiState = F("Backoff");
+            break;
+
+        default:
+            break;
+    }
+
     Serial.println(F("\nWiFi status:"));
     Serial.printf("\tStatus : %s\n", wifiStatus.c_str());
+    Serial.printf("\tState  : %s\n", wifiState.c_str());
     Serial.printf("\tIP     : %s\n\n", Wireless.getIP().c_str());
+
+    const WiFiStats &stats = Wireless.getStats();
+
+    Serial.println(F("WiFi connect statistics:"));
+    Serial.printf("\tLast      : %u ms (%s)\n", stats.lastTime, stats.lastFast ? "fast" : "scan");
+    Serial.printf("\tFast      : %u connects, avg %u ms\n", stats.fastCount,
+                    (stats.fastCount > 0) ? stats.fastTime / stats.fastCount : 0);
+    Serial.printf("\tScan      : %u connects, avg %u ms\n", stats.fullCount,
+                    (stats.fullCount > 0) ? stats.fullTime / stats.fullCount : 0);
+    Serial.printf("\tFallbacks : %u\n", stats.fallbacks);
+    Serial.printf("\tDrops     : %u\n", stats.drops);
+    Serial.printf("\tRetries   : %u\n", stats.reconnects);
+    Serial.printf("\tReason    : %u\n\n", stats.lastReason);
 }
 
 void CLIInformerClass::showInterfaces()
@@ -336,17 +395,245 @@ void CLIInformerClass::showTgBot()
     }
     Serial.printf("\tMode   : %s\n", sMode.c_str());
 
+    const TgNotifyStats &stats = TgBot.getNotifyStats();
+
+    Serial.println(F("\nNotifications:"));
+    Serial.printf("\tEvents  : %u\n", stats.queued);
+    Serial.printf("\tSent    : %u\n", stats.sent);
+    Serial.printf("\tFailed  : %u\n", stats.failed);
+    Serial.printf("\tDropped : %u\n", stats.dropped);
+
+    const TgClientStats &client = TgBot.getClientStats();
+
+    Serial.println(F("\nConnection:"));
+    Serial.printf("\tHandshakes  : %u (last %u ms)\n", client.handshakes, client.lastHandshake);
+    Serial.printf("\tReused      : %u\n", client.reuses);
+    Serial.printf("\tDNS lookups : %u\n", client.dnsLookups);
+    Serial.printf("\tLatency     : last %u ms, avg %u ms\n", client.lastLatency,
+                    (client.requests > 0) ? client.totalLatency / client.requests : 0);
+
     Serial.println(F("\nUsers:\n"));
-    Serial.println(F("\tId    Name           ChatId      Notify   Admin"));
-    Serial.println(F("\t---   ------------   ---------   ------   -----"));
+    Serial.println(F("\tId    Name           ChatId         Notify   Admin"));
+    Serial.println(F("\t---   ------------   ------------   ------   -----"));
     
     TgBot.getEnabledUsers(users);
     for (auto *user : users) {
-        Serial.printf("\t%-3d   %-12s   %-9d   %-6s   %-5s\n", i, user->name.c_str(), user->chatId,
+        Serial.printf("\t%-3d   %-12s   %-12lld   %-6s   %-5s\n", i, user->name.c_str(), (long long)user->chatId,
                     user->notify ? F("On") : F("Off"), user->admin ? F("True") : F("False"));
         i++;
     }
     Serial.println("");
 }
 
+void CLIInformerClass::showBoot()
+{
+    BootStage   *stage;
+
+    Serial.println("");
+    Serial.println(F("\tStage          Mode    Status    Start, ms   Duration, ms"));
+    Serial.println(F("\t------------   -----   -------   ---------   ------------"));
+
+    for (size_t i = 0; i < Boot.getStagesCount(); i++) {
+        String sStatus;
+
+        if (!Boot.getStage(i, &stage)) {
+            continue;
+        }
+
+        switch (stage->status) {
+            case BOOT_STATUS_WAIT:
+                sStatus = F("Wait");
+                break;
+
+            case BOOT_STATUS_RUN:
+                sStatus = F("Run");
+                break;
+
+            case BOOT_STATUS_DONE:
+                sStatus = F("Done");
+                break;
+
+            case BOOT_STATUS_FAILED:
+                sStatus = F("Failed");
+                break;
+
+            case BOOT_STATUS_SKIPPED:
+                sStatus = F("Skipped");
+                break;
+        }
+
+        Serial.printf("\t%-12s   %-5s   %-7s   %-9.1f   %-12.1f\n", stage->name.c_str(),
+            stage->async ? "Async" : "Sync", sStatus.c_str(),
+            stage->start / 1000.0, stage->duration / 1000.0);
+    }
+
+    Serial.println("");
+    Serial.printf("\tRestart       : %s\n", RtcState.isWarm() ? "Warm" : "Cold");
+    Serial.printf("\tOutputs valid : %.1f ms\n", Boot.getOutputsTime() / 1000.0);
+    if (Boot.isFinished()) {
+        Serial.printf("\tBoot total    : %.1f ms\n\n", Boot.getTotalTime() / 1000.0);
+    } else {
+        Serial.println(F("\tBoot total    : in progress\n"));
+    }
+}
+
+void CLIInformerClass::showGsm()
+{
+    Serial.println(F("\nGSM modem status:"));
+    Serial.printf("\tEnabled      : %s\n", GsmModem.getEnabled() ? "Yes" : "No");
+    Serial.printf("\tState        : %s\n", GsmModem.getStateName().c_str());
+    Serial.printf("\tRegistration : %s\n", GsmModem.getRegStatus(GsmModem.getRegistration()).c_str());
+    Serial.printf("\tOperator     : %s\n", GsmModem.getOperator().c_str());
+    Serial.printf("\tSignal       : %s\n", GsmModem.getSigLevel(GsmModem.getSignal()).c_str());
+    Serial.printf("\tIMEI         : %s\n", GsmModem.getIMEI().c_str());
+    Serial.printf("\tCCID         : %s\n", GsmModem.getCCID().c_str());
+    if (GsmModem.getError() != "") {
+        Serial.printf("\tError        : %s\n", GsmModem.getError().c_str());
+    }
+
+    const GsmAtStats &stats = GsmModem.getAtStats();
+
+    Serial.println(F("\nAT commands:"));
+    Serial.printf("\tQueued   : %u\n", GsmModem.getQueueSize());
+    Serial.printf("\tSent     : %u\n", stats.sent);
+    Serial.printf("\tErrors   : %u\n", stats.failed);
+    Serial.printf("\tTimeouts : %u\n", stats.timeouts);
+    Serial.printf("\tDropped  : %u\n", stats.dropped);
+    Serial.printf("\tURCs     : %u\n", stats.urcs);
+    Serial.printf("\tRX bytes : %u\n", stats.rxBytes);
+
+    const GsmSmsStats &sms = GsmModem.getSmsStats();
+
+    Serial.println(F("\nSMS alerts:"));
+    for (auto &phone : GsmModem.getRecipients()) {
+        Serial.printf("\tRecipient : %s\n", phone.c_str());
+    }
+    Serial.printf("\tPending   : %u\n", GsmModem.getSmsQueueSize());
+    Serial.printf("\tQueued    : %u\n", sms.queued);
+    Serial.printf("\tSent      : %u\n", sms.sent);
+    Serial.printf("\tFailed    : %u\n", sms.failed);
+    Serial.printf("\tDropped   : %u\n\n", sms.dropped);
+}
+
+void CLIInformerClass::showApi()
+{
+    const ApiWsStats &stats = APIServer.getWsStats();
+
+    Serial.println(F("\nAPI server status:"));
+    Serial.printf("\tEnabled   : %s\n", APIServer.getEnabled() ? "Yes" : "No");
+    Serial.printf("\tVersion   : %u\n", Plc.getVersion());
+
+    Serial.println(F("\nWebSocket clients:"));
+    Serial.printf("\tConnected : %u\n", APIServer.getWsClients());
+    Serial.printf("\tDeltas    : %u\n", stats.deltas);
+    Serial.printf("\tSnapshots : %u\n", stats.snapshots);
+    Serial.printf("\tSkipped   : %u\n", stats.skipped);
+    Serial.printf("\tRejected  : %u\n\n", stats.rejected);
+}
+
+void CLIInformerClass::showModbus()
+{
+    const ModbusStats &stats = Modbus.getStats();
+
+    Serial.println(F("\nModbus status:"));
+    Serial.printf("\tTCP        : %s\n", ModbusTcp.getEnabled() ? "Enabled" : "Disabled");
+    Serial.printf("\tTCP port   : %u\n", MODBUS_TCP_DEFAULT_PORT);
+    Serial.printf("\tClients    : %u\n", ModbusTcp.getClients());
+    Serial.printf("\tInputs     : %u\n", RegImage.getInputCount());
+    Serial.printf("\tRequests   : %u\n", stats.requests);
+    Serial.printf("\tWrites     : %u\n", stats.writes);
+    Serial.printf("\tExceptions : %u\n", stats.exceptions);
+
+    const ModbusRtuStats &rtu = ModbusRtu.getStats();
+
+    Serial.println(F("\nModbus RTU:"));
+    Serial.printf("\tStatus     : %s\n", ModbusRtu.isRunning() ? "Running" : (ModbusRtu.getEnabled() ? "Failed" : "Disabled"));
+    Serial.printf("\tAddress    : %u\n", ModbusRtu.getAddress());
+    Serial.printf("\tSpeed      : %u\n", ModbusRtu.getSpeed());
+    if (ModbusRtu.getDePin() == MODBUS_RTU_DE_NONE) {
+        Serial.printf("\tDE pin     : auto\n");
+    } else {
+        Serial.printf("\tDE pin     : %d\n", ModbusRtu.getDePin());
+    }
+    Serial.printf("\tFrames     : %u\n", rtu.frames);
+    Serial.printf("\tCRC errors : %u\n", rtu.crcErrors);
+    Serial.printf("\tIgnored    : %u\n", rtu.ignored);
+    Serial.printf("\tOverruns   : %u\n\n", rtu.overruns);
+}
+
+void CLIInformerClass::showMqtt()
+{
+    const MqttStats &stats = Mqtt.getStats();
+
+    Serial.println(F("\nMQTT status:"));
+    Serial.printf("\tEnabled   : %s\n", Mqtt.getEnabled() ? "Yes" : "No");
+    Serial.printf("\tBroker    : %s:%u\n", Mqtt.getHost().c_str(), Mqtt.getPort());
+    Serial.printf("\tPrefix    : %s\n", Mqtt.getPrefix().c_str());
+    Serial.printf("\tPeriod    : %u ms\n", Mqtt.getPeriod());
+    Serial.printf("\tConnected : %s\n", Mqtt.isConnected() ? "Yes" : "No");
+
+    Serial.println(F("\nMessages:"));
+    Serial.printf("\tQueued    : %u\n", Mqtt.getQueueSize());
+    Serial.printf("\tMax queue : %u\n", stats.maxQueue);
+    Serial.printf("\tPublished : %u\n", stats.published);
+    Serial.printf("\tBytes     : %u\n", stats.bytes);
+    Serial.printf("\tFailed    : %u\n", stats.failed);
+    Serial.printf("\tDropped   : %u\n", stats.dropped);
+    Serial.printf("\tCommands  : %u\n", stats.commands);
+    Serial.printf("\tConnects  : %u\n\n", stats.connects);
+}
+
+void CLIInformerClass::showUdp()
+{
+    const UdpStreamStats &stats = UdpStream.getStats();
+
+    Serial.println(F("\nUDP telemetry:"));
+    Serial.printf("\tEnabled : %s\n", UdpStream.getEnabled() ? "Yes" : "No");
+    Serial.printf("\tTarget  : %s:%u\n", UdpStream.getIP().toString().c_str(), UdpStream.getPort());
+    Serial.printf("\tRate    : %u Hz\n", UdpStream.getRate());
+    Serial.printf("\tFrame   : %u bytes\n", sizeof(UdpFrame));
+    Serial.printf("\tSent    : %u\n", stats.sent);
+    Serial.printf("\tFailed  : %u\n", stats.failed);
+    Serial.printf("\tLate    : %u\n\n", stats.late);
+}
+
+void CLIInformerClass::showReplica()
+{
+    const ReplicaStats  &stats = Replica.getStats();
+    ReplicaPeer         peers[REPLICA_PEERS_MAX];
+    size_t              count = Replica.getPeers(peers, REPLICA_PEERS_MAX);
+
+    Serial.println(F("\nReplication status:"));
+    Serial.printf("\tEnabled   : %s\n", Replica.getEnabled() ? "Yes" : "No");
+    Serial.printf("\tNode      : %u\n", Replica.getNode());
+    Serial.printf("\tGroup     : %s:%u\n", Replica.getGroup().toString().c_str(), Replica.getPort());
+    Serial.printf("\tVersion   : %u\n", Replica.getVersion());
+    Serial.printf("\tSent      : %u\n", stats.sent);
+    Serial.printf("\tReceived  : %u\n", stats.received);
+    Serial.printf("\tApplied   : %u\n", stats.applied);
+    Serial.printf("\tStale     : %u\n", stats.stale);
+    Serial.printf("\tJoins     : %u\n", stats.joins);
+    Serial.printf("\tInvalid   : %u\n", stats.invalid);
+    Serial.printf("\tConflicts : %u\n", stats.conflicts);
+    Serial.printf("\tOverflows : %u\n", stats.overflows);
+
+    Serial.println(F("\nPeers:"));
+    for (size_t i = 0; i < count; i++) {
+        Serial.printf("\tNode %u: %s %s version: %u sockets: %08x inputs: %016llx\n",
+                      peers[i].node, peers[i].ip.toString().c_str(), peers[i].online ? "online" : "offline",
+                      peers[i].version, peers[i].coils, peers[i].inputs);
+    }
+
+    Serial.println(F("\nMapped pins:"));
+    for (size_t i = 0; i < Replica.getMapCount(); i++) {
+        const ReplicaMap &map = Replica.getMap(i);
+
+        Serial.printf("\tPin %u: node %u %s %u level: %s\n", map.pin->id, map.node,
+                      (map.source == REPLICA_SRC_SOCKET) ? "socket" : "input",
+                      (map.source == REPLICA_SRC_SOCKET) ? map.index + 1 : map.index,
+                      map.pin->state ? "high" : "low");
+    }
+    Serial.println("");
+}
+
 CLIInformerClass CLIInformer;
@@ -28,15 +28,36 @@ bool ExtendersClass::begin()
         _ext[i].addr = bus.addr;
         _ext[i].enabled = true;
 
+        _ext[i].active = false;
+
         if (!I2C.getI2cBusById(bus.i2c, &_ext[i].i2c)) {
             Log.error(F("EXT"), "I2C id: " +String(bus.i2c)+ " not found.");
             return false;
         }
+    }
+    return true;
+}
+
+void ExtendersClass::probe(size_t index)
+{
+    I2cBus *bus = nullptr;
+
+    if (!I2C.getI2cBus(index, &bus)) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < PROF_EXT_MAX; i++) {
+        if (!_ext[i].enabled || _ext[i].i2c != bus) {
+            continue;
+        }
         if (_ext[i].mcp.begin_I2C(_ext[i].addr, _ext[i].i2c->wire)) {
             _ext[i].active = true;
+            I2C.account(_ext[i].i2c, true);
+        } else {
+            I2C.account(_ext[i].i2c, false);
+            Log.warning(F("EXT"), "Extender id: " +String(_ext[i].id)+ " not found at I2C id: " +String(bus->id));
         }
     }
-    return true;
 }
 
 bool ExtendersClass::getExtenderById(uint8_t id, Extender **ext)
@@ -52,12 +73,65 @@ bool ExtendersClass::getExtenderById(uint8_t id, Extender **ext)
 
 void ExtendersClass::write(Extender *ext, uint16_t pin, bool state)
 {
-    ext->mcp.digitalWrite(pin, state);
+    uint16_t gpio;
+
+    if (_batch) {
+        if (state) {
+            ext->setMask |= (1 << pin);
+            ext->clrMask &= ~(1 << pin);
+        } else {
+            ext->clrMask |= (1 << pin);
+            ext->setMask &= ~(1 << pin);
+        }
+        return;
+    }
+
+    if (ext->active && _readPorts(ext, gpio)) {
+        _writePorts(ext, state ? (gpio | (1 << pin)) : (gpio & ~(1 << pin)));
+    }
+}
+
+void ExtendersClass::beginBatch()
+{
+    _batch = true;
+}
+
+void ExtendersClass::commit()
+{
+    uint16_t gpio;
+
+    /*
+     * Writes collected since beginBatch() go out as one read and
+     * one write of both ports per extender instead of per pin.
+     */
+
+    _batch = false;
+
+    for (size_t i = 0; i < _ext.size(); i++) {
+        if (_ext[i].setMask == 0 && _ext[i].clrMask == 0) {
+            continue;
+        }
+        if (_ext[i].active && _readPorts(&_ext[i], gpio)) {
+            _writePorts(&_ext[i], (gpio | _ext[i].setMask) & ~_ext[i].clrMask);
+        }
+        _ext[i].setMask = 0;
+        _ext[i].clrMask = 0;
+    }
 }
 
 bool ExtendersClass::read(Extender *ext, uint16_t pin)
 {
-    return ext->mcp.digitalRead(pin);
+    uint16_t gpio;
+
+    /*
+     * Missing extender or a failed read gives the idle level of a
+     * pulled-up input
+     */
+
+    if (!ext->active || !_readPorts(ext, gpio)) {
+        return true;
+    }
+    return (gpio & (1 << pin)) != 0;
 }
 
 void ExtendersClass::setPinMode(Extender *ext, uint16_t pin, uint8_t mode)
@@ -74,4 +148,47 @@ void ExtendersClass::getExtenders(std::vector<Extender *> &ext)
     }
 }
 
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+bool ExtendersClass::_readPorts(Extender *ext, uint16_t &value)
+{
+    TwoWire *wire = ext->i2c->wire;
+    bool    ok = false;
+
+    /*
+     * Port transfers go through Wire directly, the MCP library hides
+     * NACKs and bus errors which the I2C counters need.
+     */
+
+    wire->beginTransmission((uint8_t)ext->addr);
+    wire->write(EXT_MCP_REG_GPIO);
+    if (wire->endTransmission(false) == 0 && wire->requestFrom((uint8_t)ext->addr, (uint8_t)2) == 2) {
+        value = wire->read();
+        value |= (uint16_t)wire->read() << 8;
+        ok = true;
+    }
+
+    I2C.account(ext->i2c, ok);
+    return ok;
+}
+
+bool ExtendersClass::_writePorts(Extender *ext, uint16_t value)
+{
+    TwoWire *wire = ext->i2c->wire;
+    bool    ok;
+
+    wire->beginTransmission((uint8_t)ext->addr);
+    wire->write(EXT_MCP_REG_GPIO);
+    wire->write((uint8_t)(value & 0xFF));
+    wire->write((uint8_t)(value >> 8));
+    ok = (wire->endTransmission() == 0);
+
+    I2C.account(ext->i2c, ok);
+    return ok;
+}
+
 ExtendersClass Extenders;
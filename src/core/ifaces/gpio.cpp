@@ -12,6 +12,7 @@
 #include "core/ifaces/gpio.hpp"
 #include "core/ext.hpp"
 #include "boards/boards.hpp"
+#include "core/rtcstate.hpp"
 
 /*********************************************************************/
 /*                                                                   */
@@ -59,13 +60,25 @@ bool GpioClass::begin()
             Log.info(F("GPIO"), "GPIO id: " +String(_pins[i].id)+ " inited at Extender ext: " +String(_pins[i].ext->id)+" pin: " +String(_pins[i].pin));
         }
 
-        _beginPin(&_pins[i]);
+        /*
+         * Extenders keep their outputs over a warm restart, leave them
+         * as is so relays do not drop until sockets are restored.
+         */
+
+        if (_pins[i].ext == nullptr || !RtcState.isWarm()) {
+            _beginPin(&_pins[i]);
+        }
     }
     return true;
 }
 
 void GpioClass::write(GpioPin *pin, bool val)
 {
+    if (pin->type == GPIO_TYPE_VIRTUAL) {
+        pin->state = val;
+        return;
+    }
+
     if (pin->ext == nullptr) {
         digitalWrite(pin->pin, (val == true) ? HIGH : LOW);
     } else {
@@ -74,14 +87,38 @@ void GpioClass::write(GpioPin *pin, bool val)
     pin->state = val;
 }
 
+void GpioClass::beginBatch()
+{
+    Extenders.beginBatch();
+}
+
+void GpioClass::commit()
+{
+    Extenders.commit();
+}
+
 bool GpioClass::read(GpioPin *pin)
 {
+    bool val;
+
+    if (pin->type == GPIO_TYPE_VIRTUAL) {
+        return pin->state;
+    }
+
     if (pin->ext == nullptr) {
-        return (digitalRead(pin->pin) == HIGH) ? true : false;
+        val = (digitalRead(pin->pin) == HIGH) ? true : false;
     } else {
-        return Extenders.read(pin->ext, pin->pin);
+        val = Extenders.read(pin->ext, pin->pin);
     }
-    return false;
+
+    /*
+     * Last level of inputs is kept for the register image
+     */
+
+    if (pin->type == GPIO_TYPE_INPUT) {
+        pin->state = val;
+    }
+    return val;
 }
 
 bool GpioClass::getState(GpioPin *pin)
@@ -126,6 +163,10 @@ void GpioClass::setMode(GpioPin *pin, GpioMode mode, GpioPull pull)
 {
     uint8_t m = INPUT;
 
+    if (pin->type == GPIO_TYPE_VIRTUAL) {
+        return;
+    }
+
     if (mode == GPIO_MOD_INPUT && pull == GPIO_PULL_NONE) {
         m = INPUT;
     } else if (mode == GPIO_MOD_INPUT && pull == GPIO_PULL_UP) {
@@ -145,6 +186,40 @@ void GpioClass::setMode(GpioPin *pin, GpioMode mode, GpioPull pull)
     }
 }
 
+bool GpioClass::addVirtual(uint16_t id, GpioPin **pin)
+{
+    GpioPin *found;
+
+    if (getPinById(id, &found)) {
+        if (found->type != GPIO_TYPE_VIRTUAL) {
+            return false;
+        }
+        *pin = found;
+        return true;
+    }
+
+    /*
+     * Virtual pins have no hardware behind them, they hold a level set
+     * by software and are placed after the board profile pins. Idle
+     * level is high, the same as a released button with pull-up.
+     */
+
+    for (uint16_t i = PROF_GPIO_MAX; i < _pins.size(); i++) {
+        if (_pins[i].enabled) {
+            continue;
+        }
+        memset(&_pins[i], 0x0, sizeof(GpioPin));
+        _pins[i].id = id;
+        _pins[i].type = GPIO_TYPE_VIRTUAL;
+        _pins[i].mode = GPIO_MOD_INPUT;
+        _pins[i].state = true;
+        _pins[i].enabled = true;
+        *pin = &_pins[i];
+        return true;
+    }
+    return false;
+}
+
 /*********************************************************************/
 /*                                                                   */
 /*                          PRIVATE FUNCTIONS                        */
@@ -19,6 +19,16 @@ bool I2cClass::begin()
     for (uint8_t i = 0; i < PROF_I2C_MAX; i++) {
         auto bus = ActiveBoard.interfaces.i2c[i];
 
+        /*
+         * Profiles list only the buses the board has, the rest of
+         * the table is zero filled.
+         */
+
+        if (!isPresent(i)) {
+            _i2c[i].enabled = false;
+            continue;
+        }
+
         _i2c[i].enabled = true;
         _i2c[i].sda = bus.sda;
         _i2c[i].scl = bus.scl;
@@ -42,6 +52,14 @@ bool I2cClass::begin()
     return true;
 }
 
+bool I2cClass::isPresent(size_t index) const
+{
+    if (index >= PROF_I2C_MAX) {
+        return false;
+    }
+    return (ActiveBoard.interfaces.i2c[index].sda != ActiveBoard.interfaces.i2c[index].scl);
+}
+
 bool I2cClass::getI2cBusById(uint8_t id, I2cBus **bus)
 {
     for (uint8_t i = 0; i < _i2c.size(); i++) {
@@ -53,6 +71,26 @@ bool I2cClass::getI2cBusById(uint8_t id, I2cBus **bus)
     return false;
 }
 
+bool I2cClass::getI2cBus(size_t index, I2cBus **bus)
+{
+    if (index >= _i2c.size() || !_i2c[index].enabled) {
+        return false;
+    }
+    *bus = &_i2c[index];
+    return true;
+}
+
+void I2cClass::account(I2cBus *bus, bool ok, unsigned count)
+{
+    if (bus == nullptr) {
+        return;
+    }
+    bus->transactions += count;
+    if (!ok) {
+        bus->errors++;
+    }
+}
+
 void I2cClass::getI2cBuses(std::vector<I2cBus *> &buses)
 {
     for (uint8_t i = 0; i < _i2c.size(); i++) {
@@ -0,0 +1,76 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "core/metrics.hpp"
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+void MetricsClass::loopBegin()
+{
+    _loopStart = micros();
+}
+
+void MetricsClass::loopEnd()
+{
+    unsigned time = micros() - _loopStart;
+
+    _loop.count++;
+    _loop.last = time;
+    _loop.total += time;
+    if (time > _loop.max) {
+        _loop.max = time;
+    }
+}
+
+const MetricsLoop &MetricsClass::getLoop() const
+{
+    return _loop;
+}
+
+void MetricsClass::owRead(uint64_t id, bool ok)
+{
+    MetricsOwSensor *sensor = nullptr;
+
+    for (size_t i = 0; i < _owCount; i++) {
+        if (_ow[i].id == id) {
+            sensor = &_ow[i];
+            break;
+        }
+    }
+
+    if (sensor == nullptr) {
+        if (_owCount == METRICS_OW_SENSORS_MAX) {
+            return;
+        }
+        sensor = &_ow[_owCount++];
+        sensor->id = id;
+    }
+
+    sensor->reads++;
+    if (!ok) {
+        sensor->fails++;
+    }
+}
+
+bool MetricsClass::getOwSensor(size_t index, const MetricsOwSensor **sensor) const
+{
+    if (index >= _owCount) {
+        return false;
+    }
+    *sensor = &_ow[index];
+    return true;
+}
+
+MetricsClass Metrics;
@@ -11,6 +11,9 @@
 
 #include "core/plc.hpp"
 #include "boards/boards.hpp"
+#include "core/rtcstate.hpp"
+#include "net/core/gsm.hpp"
+#include "net/tgbot.hpp"
 
 /*********************************************************************/
 /*                                                                   */
@@ -24,18 +27,47 @@ PlcClass::PlcClass()
 
 void PlcClass::setAlarm(PlcMod mod, bool status)
 {
+    bool last = (_alarm & (1 << mod));
+
+    /*
+     * GSM alarm is not reported over GSM itself
+     */
+
+    if (last != status && mod != PLC_MOD_GSM) {
+        switch (mod) {
+            case PLC_MOD_WIFI:
+                GsmModem.sendAlert(status ? F("Wi-Fi alarm") : F("Wi-Fi restored"));
+                TgBot.notify(TG_NOTIFY_ALARM, status ? F("Авария Wi-Fi") : F("Wi-Fi восстановлен"));
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (last != status) {
+        updateVersion();
+    }
+
     if (status) {
         _alarm |= (1 << mod);
     } else {
         _alarm &= ~(1 << mod);
     }
 
+    RtcState.setAlarm(_alarm);
+
     if (_alarm == 0) {
         _lastAlarm = false;
         if (_pins[PLC_GPIO_ALARM_LED] != nullptr) { Gpio.write(_pins[PLC_GPIO_ALARM_LED], false); }
     }
 }
 
+unsigned PlcClass::getAlarm() const
+{
+    return _alarm;
+}
+
 void PlcClass::setBuzzer(PlcMod mod, bool status)
 {
     if (status) {
@@ -70,6 +102,26 @@ const String& PlcClass::getName() const
     return _name;
 }
 
+uint32_t PlcClass::updateVersion()
+{
+    /*
+     * State version for API clients, bumped on every socket or sensor change.
+     * Called from the main loop and the network tasks.
+     */
+
+    return __atomic_add_fetch(&_version, 1, __ATOMIC_SEQ_CST);
+}
+
+uint32_t PlcClass::getVersion() const
+{
+    return __atomic_load_n(&_version, __ATOMIC_SEQ_CST);
+}
+
+uint32_t PlcClass::getBoot() const
+{
+    return _boot;
+}
+
 void PlcClass::setName(const String &name)
 {
     _name = name;
@@ -79,6 +131,18 @@ void PlcClass::begin()
 {
     I2cBus *bus = nullptr;
 
+    /*
+     * Versions restart from 1 on every boot, the boot id tells API
+     * clients that their cached version is from another run.
+     */
+
+    _boot = esp_random();
+
+    if (RtcState.isWarm()) {
+        _alarm = RtcState.getAlarm();
+        _brdTemp = RtcState.getBoardTemp();
+    }
+
     if (!Gpio.getPinById(ActiveBoard.plc.gpio.fan, &_pins[PLC_GPIO_FAN])) {
         Log.error(F("PLC"), F("GPIO FAN not found"));
     }
@@ -108,6 +172,7 @@ void PlcClass::begin()
         Log.error(F("PLC"), F("I2C bus temp not found"));
     } else {
         _tempSensor.begin(ActiveBoard.plc.temp.addr, bus->wire);
+        _tempBus = bus;
         Log.info(F("PLC"), String(F("Board temp sensor inited at bus: ")) +
                 String(bus->id) + String(F(" addr: 0x")) +
                 String(ActiveBoard.plc.temp.addr, HEX));
@@ -253,7 +318,23 @@ void PlcClass::_taskAlarmBuzzer()
 
 void PlcClass::_taskFan()
 {
-    _brdTemp = _tempSensor.getTemperature();
+    float   temp = _tempSensor.getTemperature();
+    bool    valid = !isnan(temp) && temp >= PLC_LM75_TEMP_MIN && temp <= PLC_LM75_TEMP_MAX;
+
+    /*
+     * A missing or failing sensor reads as NaN or out of the LM75
+     * range, the last good temperature is kept for the fan.
+     */
+
+    if (_tempBus != nullptr) {
+        I2C.account(_tempBus, valid);
+    }
+
+    if (valid && temp != _brdTemp) {
+        _brdTemp = temp;
+        updateVersion();
+    }
+    RtcState.setBoardTemp(_brdTemp);
 
     if (!_fanEnabled) {
         return;
@@ -263,6 +344,7 @@ void PlcClass::_taskFan()
         if (_pins[PLC_GPIO_FAN] != nullptr) { 
             Gpio.write(_pins[PLC_GPIO_FAN], true);
             _fanStatus = true;
+            updateVersion();
             Log.info(F("PLC"), String(F("FAN status changed to ON. Temp: ")) +
                     String(_brdTemp) + String(F(" > MaxTemp: ")) +
                     String(PLC_BRD_TEMP_MAX));
@@ -271,6 +353,7 @@ void PlcClass::_taskFan()
         if (_pins[PLC_GPIO_FAN] != nullptr) {
             Gpio.write(_pins[PLC_GPIO_FAN], false);
             _fanStatus = false;
+            updateVersion();
             Log.info(F("PLC"), String(F("FAN status changed to OFF. Temp: ")) +
                     String(_brdTemp) + String(F(" < MinTemp: ")) +
                     String(PLC_BRD_TEMP_MIN));
@@ -0,0 +1,195 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "core/regimage.hpp"
+#include "core/plc.hpp"
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+void RegImageClass::addSensor(MeteoSensor *sensor)
+{
+    if (_sensorCount == REGIMAGE_SENSORS_MAX) {
+        Log.warning(F("REGS"), String(F("No input register for sensor: ")) + sensor->getName());
+        return;
+    }
+    _sensors[_sensorCount++] = sensor;
+}
+
+void RegImageClass::read(RegImageData &data)
+{
+    if (_lock == nullptr) {
+        memset(&data, 0x0, sizeof(RegImageData));
+        return;
+    }
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    memcpy(&data, &_data, sizeof(RegImageData));
+    xSemaphoreGive(_lock);
+}
+
+bool RegImageClass::isCoil(uint16_t addr) const
+{
+    return (addr < REGIMAGE_COILS && (_data.sockets & (1UL << addr)));
+}
+
+bool RegImageClass::writeCoil(uint16_t addr, bool value)
+{
+    RegImageWrite   msg = { addr, value };
+
+    /*
+     * Applied from the main loop, protocol tasks never touch GPIO
+     */
+
+    if (_writes == nullptr || !isCoil(addr)) {
+        return false;
+    }
+    return (xQueueSend(_writes, &msg, 0) == pdTRUE);
+}
+
+size_t RegImageClass::getInputCount() const
+{
+    return _inputCount;
+}
+
+size_t RegImageClass::getSensorCount() const
+{
+    return _sensorCount;
+}
+
+MeteoSensor *RegImageClass::getSensor(size_t index) const
+{
+    return (index < _sensorCount) ? _sensors[index] : nullptr;
+}
+
+void RegImageClass::begin()
+{
+    std::vector<GpioPin *>  pins;
+
+    _lock = xSemaphoreCreateMutex();
+    _writes = xQueueCreate(REGIMAGE_WRITES_MAX, sizeof(RegImageWrite));
+
+    Gpio.getPinsByType(GPIO_TYPE_INPUT, pins);
+    for (auto *pin : pins) {
+        if (_inputCount == REGIMAGE_INPUTS) {
+            break;
+        }
+        _inputs[_inputCount++] = pin;
+        Gpio.read(pin);
+    }
+
+    _refresh();
+
+    Log.info(F("REGS"), String(F("Register image coils: ")) + String(REGIMAGE_COILS) +
+                        String(F(" inputs: ")) + String(_inputCount) +
+                        String(F(" sensors: ")) + String(_sensorCount));
+}
+
+void RegImageClass::loop()
+{
+    if (_lock == nullptr) return;
+
+    _applyWrites();
+
+    /*
+     * One input per scan, the same way socket buttons are polled
+     */
+
+    if (_inputCount > 0) {
+        Gpio.read(_inputs[_curInput]);
+        _curInput = (_curInput + 1) % _inputCount;
+    }
+
+    _refresh();
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void RegImageClass::_applyWrites()
+{
+    RegImageWrite   msg;
+    Socket          *socket;
+
+    if (uxQueueMessagesWaiting(_writes) == 0) {
+        return;
+    }
+
+    SocketCtrl.beginBatch();
+    while (xQueueReceive(_writes, &msg, 0) == pdTRUE) {
+        if (SocketCtrl.getSocket((size_t)msg.addr, &socket) && socket->enabled && socket->status != msg.value) {
+            SocketCtrl.setStatus(socket, msg.value, true);
+        }
+    }
+    SocketCtrl.commitBatch();
+}
+
+void RegImageClass::_refresh()
+{
+    RegImageData    data = {};
+    Socket          *socket;
+
+    data.version = Plc.getVersion();
+
+    for (size_t i = 0; i < REGIMAGE_COILS && SocketCtrl.getSocket(i, &socket); i++) {
+        if (!socket->enabled) {
+            continue;
+        }
+        data.sockets |= (1UL << i);
+        if (socket->status) {
+            data.coils |= (1UL << i);
+        }
+    }
+
+    for (size_t i = 0; i < _inputCount; i++) {
+        if (!_inputs[i]->state) {
+            data.inputs |= (1ULL << i);
+        }
+    }
+
+    data.iregs[REGIMAGE_IREG_BOARD] = _tenths(Plc.getBoardTemp());
+    data.iregs[REGIMAGE_IREG_ALARM] = (int16_t)Plc.getAlarm();
+    for (size_t i = 0; i < _sensorCount; i++) {
+        data.iregs[REGIMAGE_IREG_SENSORS + i] = _tenths(_sensors[i]->getTemperature());
+    }
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    memcpy(&_data, &data, sizeof(RegImageData));
+    xSemaphoreGive(_lock);
+}
+
+int16_t RegImageClass::_tenths(float value) const
+{
+    /*
+     * NaN and out of range floats can't be cast, the sentinel is
+     * kept out of the clamped range.
+     */
+
+    if (isnan(value)) {
+        return REGIMAGE_IREG_INVALID;
+    }
+    value *= 10;
+    if (value >= INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (value <= INT16_MIN + 1) {
+        return INT16_MIN + 1;
+    }
+    return (int16_t)value;
+}
+
+RegImageClass RegImage;
@@ -0,0 +1,188 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "core/rtcstate.hpp"
+#include "utils/log.hpp"
+#include "controllers/socket/socket.hpp"
+
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_rom_crc.h>
+
+/*
+ * Not initialized on boot, so the snapshot survives software and
+ * watchdog resets but not power loss.
+ */
+
+RTC_NOINIT_ATTR static RtcSnapshot rtcSnapshot;
+
+/*
+ * Setters run on the main loop and the network tasks, the field and
+ * its CRC are updated together so a warm start never sees a torn
+ * snapshot.
+ */
+
+static portMUX_TYPE rtcLock = portMUX_INITIALIZER_UNLOCKED;
+
+static_assert(SOCKET_COUNT <= sizeof(rtcSnapshot.sockets) * 8, "RTC snapshot holds one bit per socket");
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+void RtcStateClass::begin()
+{
+    esp_reset_reason_t reason = esp_reset_reason();
+
+    switch (reason) {
+        case ESP_RST_SW:
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+            _warm = _isValid();
+            break;
+
+        default:
+            _warm = false;
+            break;
+    }
+
+    if (_warm) {
+        Log.info(F("RTC"), String(F("Warm restart detected. Reason: ")) + String(reason));
+    } else {
+        _reset();
+    }
+}
+
+bool RtcStateClass::isWarm() const
+{
+    return _warm;
+}
+
+void RtcStateClass::setSocket(size_t id, bool status)
+{
+    if (id == 0 || id > SOCKET_COUNT) {
+        return;
+    }
+    portENTER_CRITICAL(&rtcLock);
+    if (status) {
+        rtcSnapshot.sockets |= (1UL << (id - 1));
+    } else {
+        rtcSnapshot.sockets &= ~(1UL << (id - 1));
+    }
+    _update();
+    portEXIT_CRITICAL(&rtcLock);
+}
+
+bool RtcStateClass::getSocket(size_t id, bool &status) const
+{
+    if (!_warm || id == 0 || id > SOCKET_COUNT) {
+        return false;
+    }
+    status = (rtcSnapshot.sockets & (1UL << (id - 1))) != 0;
+    return true;
+}
+
+void RtcStateClass::setAlarm(uint32_t alarm)
+{
+    portENTER_CRITICAL(&rtcLock);
+    rtcSnapshot.alarm = alarm;
+    _update();
+    portEXIT_CRITICAL(&rtcLock);
+}
+
+uint32_t RtcStateClass::getAlarm() const
+{
+    return rtcSnapshot.alarm;
+}
+
+void RtcStateClass::setBoardTemp(float temp)
+{
+    portENTER_CRITICAL(&rtcLock);
+    rtcSnapshot.brdTemp = temp;
+    _update();
+    portEXIT_CRITICAL(&rtcLock);
+}
+
+float RtcStateClass::getBoardTemp() const
+{
+    return rtcSnapshot.brdTemp;
+}
+
+void RtcStateClass::setWiFi(uint8_t channel, const uint8_t *bssid)
+{
+    if (bssid == nullptr) {
+        return;
+    }
+    portENTER_CRITICAL(&rtcLock);
+    rtcSnapshot.wifiChannel = channel;
+    memcpy(rtcSnapshot.wifiBssid, bssid, RTC_STATE_BSSID_LEN);
+    rtcSnapshot.wifiValid = true;
+    _update();
+    portEXIT_CRITICAL(&rtcLock);
+}
+
+bool RtcStateClass::getWiFi(uint8_t &channel, uint8_t *bssid) const
+{
+    if (!_warm || !rtcSnapshot.wifiValid) {
+        return false;
+    }
+    portENTER_CRITICAL(&rtcLock);
+    channel = rtcSnapshot.wifiChannel;
+    memcpy(bssid, rtcSnapshot.wifiBssid, RTC_STATE_BSSID_LEN);
+    portEXIT_CRITICAL(&rtcLock);
+    return true;
+}
+
+void RtcStateClass::clearWiFi()
+{
+    portENTER_CRITICAL(&rtcLock);
+    rtcSnapshot.wifiValid = false;
+    _update();
+    portEXIT_CRITICAL(&rtcLock);
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+bool RtcStateClass::_isValid() const
+{
+    if (rtcSnapshot.magic != RTC_STATE_MAGIC ||
+        rtcSnapshot.version != RTC_STATE_VERSION ||
+        rtcSnapshot.size != sizeof(RtcSnapshot)) {
+        return false;
+    }
+    return esp_rom_crc32_le(0, (const uint8_t *)&rtcSnapshot, offsetof(RtcSnapshot, crc)) == rtcSnapshot.crc;
+}
+
+void RtcStateClass::_reset()
+{
+    portENTER_CRITICAL(&rtcLock);
+    memset(&rtcSnapshot, 0x0, sizeof(RtcSnapshot));
+    rtcSnapshot.magic = RTC_STATE_MAGIC;
+    rtcSnapshot.version = RTC_STATE_VERSION;
+    rtcSnapshot.size = sizeof(RtcSnapshot);
+    _update();
+    portEXIT_CRITICAL(&rtcLock);
+}
+
+void RtcStateClass::_update()
+{
+    rtcSnapshot.crc = esp_rom_crc32_le(0, (const uint8_t *)&rtcSnapshot, offsetof(RtcSnapshot, crc));
+}
+
+RtcStateClass RtcState;
@@ -27,6 +27,7 @@ bool EepromDbClass::begin()
         Log.error(F("EEDB"), F("I2C bus EEPROM not found"));
         return false;
     } else {
+        _bus = bus;
         _ee.begin(ActiveBoard.eeprom.addr, bus->wire, I2C_DEVICESIZE_24LC512, -1);
         if (_ee.isConnected()) {
             size = _ee.getDeviceSize();
@@ -50,19 +51,23 @@ bool EepromDbClass::getEnabled() const
 
 size_t EepromDbClass::getOffset(EeDbOffset offset)
 {
-    size_t out = 0;
-
     switch (offset) {
         case EE_DB_OFFSET_SOCKET:
-            return out;
+            return EE_DB_ADDR_SOCKET;
+
+        case EE_DB_OFFSET_WIFI:
+            return EE_DB_ADDR_WIFI;
+
+        case EE_DB_OFFSET_SMS:
+            return EE_DB_ADDR_SMS;
     }
-    return out;
+    return EE_DB_ADDR_SOCKET;
 }
 
 bool EepromDbClass::loadSocketDb(EeDbSocket &sockdb)
 {
     if (_ee.isConnected()) {
-        _ee.readBlock(getOffset(EE_DB_OFFSET_SOCKET), (uint8_t *)&sockdb, sizeof(EeDbSocket));
+        _account(_ee.readBlock(getOffset(EE_DB_OFFSET_SOCKET), (uint8_t *)&sockdb, sizeof(EeDbSocket)) == sizeof(EeDbSocket));
         return true;
     }
     return false;
@@ -73,8 +78,8 @@ bool EepromDbClass::saveSocketDb(EeDbSocket &sockdb)
     size_t offset = getOffset(EE_DB_OFFSET_SOCKET);
 
     if (_ee.isConnected()) {
-        _ee.setBlock(offset, 0x0, sizeof(EeDbSocket));
-        _ee.writeBlock(offset, (uint8_t *)&sockdb, sizeof(EeDbSocket));
+        _account(_ee.setBlock(offset, 0x0, sizeof(EeDbSocket)) == 0);
+        _account(_ee.writeBlock(offset, (uint8_t *)&sockdb, sizeof(EeDbSocket)) == 0);
         return true;
     }
 
@@ -110,4 +115,71 @@ bool EepromDbClass::setSocketStatus(EeDbSocket &sockdb, uint8_t id, bool status)
     return true;
 }
 
+bool EepromDbClass::loadWiFiDb(EeDbWiFi &wifidb)
+{
+    if (!_ee.isConnected()) {
+        return false;
+    }
+
+    _account(_ee.readBlock(getOffset(EE_DB_OFFSET_WIFI), (uint8_t *)&wifidb, sizeof(EeDbWiFi)) == sizeof(EeDbWiFi));
+    if (wifidb.magic != EE_DB_WIFI_MAGIC) {
+        memset(&wifidb, 0x0, sizeof(EeDbWiFi));
+        return false;
+    }
+
+    return true;
+}
+
+bool EepromDbClass::saveWiFiDb(EeDbWiFi &wifidb)
+{
+    if (!_ee.isConnected()) {
+        return false;
+    }
+
+    wifidb.magic = EE_DB_WIFI_MAGIC;
+    _ee.updateBlock(getOffset(EE_DB_OFFSET_WIFI), (uint8_t *)&wifidb, sizeof(EeDbWiFi));
+    _account(true);
+
+    return true;
+}
+
+bool EepromDbClass::loadSmsDb(EeDbSms &smsdb)
+{
+    if (!_ee.isConnected()) {
+        return false;
+    }
+
+    _account(_ee.readBlock(getOffset(EE_DB_OFFSET_SMS), (uint8_t *)&smsdb, sizeof(EeDbSms)) == sizeof(EeDbSms));
+    if (smsdb.magic != EE_DB_SMS_MAGIC || smsdb.count > EE_DB_SMS_MAX) {
+        memset(&smsdb, 0x0, sizeof(EeDbSms));
+        return false;
+    }
+
+    return true;
+}
+
+bool EepromDbClass::saveSmsDb(EeDbSms &smsdb)
+{
+    if (!_ee.isConnected()) {
+        return false;
+    }
+
+    smsdb.magic = EE_DB_SMS_MAGIC;
+    _ee.updateBlock(getOffset(EE_DB_OFFSET_SMS), (uint8_t *)&smsdb, sizeof(EeDbSms));
+    _account(true);
+
+    return true;
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void EepromDbClass::_account(bool ok)
+{
+    I2C.account(_bus, ok);
+}
+
 EepromDbClass EeDb;
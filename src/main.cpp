@@ -26,31 +26,133 @@
 #include "core/ifaces/ow.hpp"
 #include "ftest.hpp"
 #include "db/eedb.h"
+#include "core/boot.hpp"
+#include "boards/boards.hpp"
+#include "core/rtcstate.hpp"
+#include "core/metrics.hpp"
+#include "core/regimage.hpp"
+#include "net/modbustcp.hpp"
+#include "net/modbusrtu.hpp"
+#include "net/mqtt.hpp"
+#include "net/udpstream.hpp"
+#include "net/replica.hpp"
 
 void setup()
 {
+    Boot.begin();
     Log.begin();
-    delay(1000);
+#if BOOT_SERIAL_DELAY_MS > 0
+    delay(BOOT_SERIAL_DELAY_MS);
+#endif
     Serial.println("");
     Log.info(F("MAIN"), F("Starting controller..."));
-    I2C.begin();
-    OneWireIf.begin();
-    Extenders.begin();
-    Gpio.begin();
-    if (!Configs.begin()) return;
-    EeDb.begin();
-    Plc.begin();
-    Wireless.begin();
-    TgBot.begin();
-    GsmModem.begin();
-    APIServer.begin();
-    Controllers.begin();
+    RtcState.begin();
+
+    /*
+     * Boot graph: flash mount, extenders probing on both I2C buses and
+     * EEPROM run concurrently, outputs are restored before networking.
+     */
+
+    Boot.addStage(BOOT_STAGE_I2C, F("I2C"), []() {
+        I2C.begin();
+        return true;
+    }, 0, false);
+    Boot.addStage(BOOT_STAGE_FLASH, F("Flash"), []() {
+        Configs.mount();
+        return true;
+    }, 0, true);
+    Boot.addStage(BOOT_STAGE_ONEWIRE, F("OneWire"), []() {
+        OneWireIf.begin();
+        return true;
+    }, 0, false);
+    Boot.addStage(BOOT_STAGE_EXT, F("Extenders"), []() {
+        Extenders.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_I2C), false);
+
+    /*
+     * One probe stage per bus the board has, keyed by bus index.
+     * A stage that is not added counts as done for GPIO.
+     */
+
+    if (I2C.isPresent(0)) {
+        Boot.addStage(BOOT_STAGE_EXT_BUS_1, F("Ext bus 1"), []() {
+            Extenders.probe(0);
+            return true;
+        }, BOOT_DEP(BOOT_STAGE_EXT), true);
+    }
+    if (I2C.isPresent(1)) {
+        Boot.addStage(BOOT_STAGE_EXT_BUS_2, F("Ext bus 2"), []() {
+            Extenders.probe(1);
+            return true;
+        }, BOOT_DEP(BOOT_STAGE_EXT), true);
+    }
+    Boot.addStage(BOOT_STAGE_GPIO, F("GPIO"), []() {
+        Gpio.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_EXT_BUS_1) | BOOT_DEP(BOOT_STAGE_EXT_BUS_2), false);
+    Boot.addStage(BOOT_STAGE_EEPROM, F("EEPROM"), []() {
+        EeDb.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_I2C), true);
+    Boot.addStage(BOOT_STAGE_CONFIGS, F("Configs"), []() {
+        return Configs.begin();
+    }, BOOT_DEP(BOOT_STAGE_GPIO) | BOOT_DEP(BOOT_STAGE_FLASH), false);
+    Boot.addStage(BOOT_STAGE_CTRLS, F("Controllers"), []() {
+        Controllers.begin();
+        Boot.setOutputsValid();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_CONFIGS) | BOOT_DEP(BOOT_STAGE_EEPROM), false);
+    Boot.addStage(BOOT_STAGE_PLC, F("PLC"), []() {
+        Plc.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_CONFIGS), false);
+    Boot.addStage(BOOT_STAGE_WIFI, F("Wi-Fi"), []() {
+        Wireless.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_PLC) | BOOT_DEP(BOOT_STAGE_EEPROM), false);
+    Boot.addStage(BOOT_STAGE_TGBOT, F("Telegram"), []() {
+        TgBot.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_CONFIGS), false);
+    Boot.addStage(BOOT_STAGE_GSM, F("GSM"), []() {
+        GsmModem.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_CONFIGS) | BOOT_DEP(BOOT_STAGE_EEPROM), false);
+    Boot.addStage(BOOT_STAGE_API, F("API"), []() {
+        APIServer.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_CTRLS), false);
+    Boot.addStage(BOOT_STAGE_WEBGUI, F("WebGUI"), []() {
+        WebGUI.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_WIFI), false);
+    Boot.addStage(BOOT_STAGE_MODBUS, F("Modbus"), []() {
+        RegImage.begin();
+        ModbusTcp.begin();
+        ModbusRtu.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_CTRLS) | BOOT_DEP(BOOT_STAGE_PLC), false);
+    Boot.addStage(BOOT_STAGE_MQTT, F("MQTT"), []() {
+        Mqtt.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_MODBUS) | BOOT_DEP(BOOT_STAGE_WIFI), false);
+    Boot.addStage(BOOT_STAGE_UDP, F("UDP"), []() {
+        UdpStream.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_MODBUS) | BOOT_DEP(BOOT_STAGE_WIFI), false);
+    Boot.addStage(BOOT_STAGE_REPLICA, F("Replica"), []() {
+        Replica.begin();
+        return true;
+    }, BOOT_DEP(BOOT_STAGE_MODBUS) | BOOT_DEP(BOOT_STAGE_WIFI), false);
+
+    Boot.run();
     CLIProcessor.begin();
-    WebGUI.begin();
 }
 
 void loop()
 {
+    Metrics.loopBegin();
     CLIReader.read();
     if (CLIReader.isNewString()) {
         CLIProcessor.parse(CLIReader.getString());
@@ -59,6 +161,13 @@ void loop()
     Wireless.loop();
     Plc.loop();
     TgBot.loop();
+    GsmModem.loop();
     Controllers.loop();
+    RegImage.loop();
     WebGUI.loop();
+    APIServer.loop();
+    Mqtt.loop();
+    UdpStream.loop();
+    Replica.loop();
+    Metrics.loopEnd();
 }
@@ -11,6 +11,12 @@
 
 #include "net/apiserver.hpp"
 #include "controllers/ctrls.hpp"
+#include "net/core/gsm.hpp"
+#include "core/plc.hpp"
+#include "core/metrics.hpp"
+#include "core/ifaces/i2c.hpp"
+#include "net/core/wifi.hpp"
+#include "net/tgbot.hpp"
 
 /*********************************************************************/
 /*                                                                   */
@@ -28,20 +34,130 @@ bool APIServerClass::getEnabled() const
     return _enabled;
 }
 
+size_t APIServerClass::getWsClients()
+{
+    size_t  count = 0;
+
+    if (_wsLock == nullptr) {
+        return 0;
+    }
+
+    xSemaphoreTake(_wsLock, portMAX_DELAY);
+    for (size_t i = 0; i < API_WS_CLIENTS_MAX; i++) {
+        if (_wsClients[i].used) {
+            count++;
+        }
+    }
+    xSemaphoreGive(_wsLock);
+
+    return count;
+}
+
+const ApiWsStats &APIServerClass::getWsStats() const
+{
+    return _wsStats;
+}
+
 void APIServerClass::begin()
 {
     if (!_enabled) return;
 
     Log.info(F("API"), F("Starting API server at :8080"));
 
+    _wsLock = xSemaphoreCreateMutex();
+    _batches = xQueueCreate(API_BATCH_QUEUE_LEN, sizeof(ApiBatch));
+    memset(_wsClients, 0x0, sizeof(_wsClients));
+
+    /*
+     * Live state is pushed to WebSocket clients as deltas against
+     * the state version instead of being polled.
+     */
+
+    _ws.onEvent([this](AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
+                        void *arg, uint8_t *data, size_t len) {
+        _wsEvent(client, type, arg, data, len);
+    });
+    AsyncWebServer::addHandler(&_ws);
+
     AsyncWebServer::on("/", HTTP_GET, [this](AsyncWebServerRequest *req) {
     });
 
+    /*
+     * Registered before "/socket", which also matches its subpaths
+     */
+
+    AsyncWebServer::on("/socket/batch", HTTP_GET, [this](AsyncWebServerRequest *req) {
+        JsonDocument    jOut;
+
+        _batchStatus(req, &jOut);
+        _sendJson(req, jOut, (jOut[F("result")] && !jOut[F("applied")]) ? 202 : 200);
+    });
+
     AsyncWebServer::on("/socket", HTTP_GET, [this](AsyncWebServerRequest *req) {
         JsonDocument    jOut;
-        String          sOut;
         Socket          *socket = nullptr;
 
+        /*
+         * Full list is streamed socket by socket straight into the
+         * TCP buffers without building the document in memory.
+         * Unchanged state is answered with 304 by the ETag version.
+         */
+
+        if (req->getParam(F("name")) == nullptr && req->getParam(F("socket")) == nullptr) {
+            uint32_t                version = Plc.getVersion();
+            String                  tag = String(Plc.getBoot(), HEX) + "-" + String(version);
+            String                  etag = "\"" + tag + "\"";
+            AsyncWebServerResponse  *res;
+
+            if (req->hasHeader(F("If-None-Match")) && req->getHeader(F("If-None-Match"))->value() == etag) {
+                res = req->beginResponse(304);
+                res->addHeader(F("ETag"), etag);
+                req->send(res);
+                return;
+            }
+
+            auto state = std::make_shared<ApiChunkState>();
+
+            state->stage = API_CHUNK_BEGIN;
+            state->index = 0;
+            state->count = 0;
+            state->len = 0;
+            state->pos = 0;
+            state->version = version;
+            state->since = 0;
+            state->boot = Plc.getBoot();
+
+            /*
+             * Delta base is the ETag value "<boot>-<version>". A base
+             * from another boot or ahead of the current version can't
+             * be compared, the client has to reload the full list.
+             */
+
+            if (req->getParam(F("since")) != nullptr) {
+                const String    &since = req->getParam(F("since"))->value();
+                int             sep = since.indexOf('-');
+
+                if (sep > 0) {
+                    state->since = strtoul(since.substring(sep + 1).c_str(), nullptr, 10);
+                }
+                if (sep <= 0 || strtoul(since.substring(0, sep).c_str(), nullptr, 16) != state->boot ||
+                    state->since == 0 || state->since > version) {
+                    jOut["result"] = false;
+                    jOut["error"] = F("Version from another boot");
+                    _sendJson(req, jOut, 412);
+                    return;
+                }
+            }
+
+            res = req->beginChunkedResponse(F("application/json"),
+                [this, state](uint8_t *buf, size_t maxLen, size_t index) -> size_t {
+                    return _sendChunk(*state, buf, maxLen, &APIServerClass::_socketsNext);
+                });
+            res->addHeader(F("ETag"), etag);
+            req->send(res);
+            return;
+        }
+
         if (req->getParam(F("name")) == nullptr) {
             _socketHandler(nullptr, req, &jOut);
         } else {
@@ -53,13 +169,60 @@ void APIServerClass::begin()
             }
         }
 
-        serializeJson(jOut, sOut);
-        req->send(200, "application/json", sOut);
+        _sendJson(req, jOut);
+    });
+
+    AsyncWebServer::on("/socket/batch", HTTP_POST, [this](AsyncWebServerRequest *req) {
+        JsonDocument    jOut;
+
+        _batchHandler(req, &jOut);
+        _sendJson(req, jOut, jOut[F("result")] ? 202 : 200);
+    }, nullptr, [this](AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t index, size_t total) {
+        _batchBody(req, data, len, index, total);
+    });
+
+    AsyncWebServer::on("/metrics", HTTP_GET, [this](AsyncWebServerRequest *req) {
+        auto state = std::make_shared<ApiChunkState>();
+
+        /*
+         * Counters are rendered line by line from the live values,
+         * nothing is collected before the response starts.
+         */
+
+        state->stage = API_CHUNK_ITEMS;
+        state->index = 0;
+        state->count = 0;
+        state->len = 0;
+        state->pos = 0;
+
+        req->send(req->beginChunkedResponse(F("text/plain; version=0.0.4"),
+            [this, state](uint8_t *buf, size_t maxLen, size_t index) -> size_t {
+                return _sendChunk(*state, buf, maxLen, &APIServerClass::_metricsNext);
+            }));
+    });
+
+    AsyncWebServer::on("/gsm", HTTP_GET, [this](AsyncWebServerRequest *req) {
+        JsonDocument    jOut;
+
+        _gsmHandler(&jOut);
+        _sendJson(req, jOut);
     });
 
     AsyncWebServer::begin();
 }
 
+void APIServerClass::loop()
+{
+    if (!_enabled || _batches == nullptr) return;
+
+    _batchApply();
+
+    if (millis() - _wsTimer >= API_WS_PERIOD_MS) {
+        _wsTimer = millis();
+        _wsFlush();
+    }
+}
+
 /*********************************************************************/
 /*                                                                   */
 /*                          PRIVATE FUNCTIONS                         */
@@ -71,16 +234,28 @@ void APIServerClass::_socketHandler(Socket *sock, AsyncWebServerRequest *req, Js
     if (req->getParam(F("socket")) != nullptr) {
         if (sock != nullptr) {
             if (req->getParam(F("status")) != nullptr) {
+                ApiBatch batch = {};
+
+                /*
+                 * Switched by the main loop like a batch of one
+                 */
+
                 if (req->getParam(F("status"))->value() == "true") {
-                    SocketCtrl.setStatus(sock, true, true);
+                    batch.ops[0].op = API_SOCKET_ON;
                 } else if (req->getParam(F("status"))->value() == "false") {
-                    SocketCtrl.setStatus(sock, false, true);
+                    batch.ops[0].op = API_SOCKET_OFF;
                 } else if (req->getParam(F("status"))->value() == "switch") {
-                    SocketCtrl.setStatus(sock, !sock->status, true);
+                    batch.ops[0].op = API_SOCKET_SWITCH;
                 } else {
                     _sendError(out, F("Unknown socket status"));
                     return;
                 }
+                batch.ops[0].index = (uint8_t)(sock - SocketCtrl.getSockets()->data());
+                batch.count = 1;
+                if (!_batchQueue(batch)) {
+                    _sendError(out, F("Socket write queue is full"));
+                    return;
+                }
             } else {
                 (*out)[F("name")] = sock->name;
                 (*out)[F("status")] = sock->status;
@@ -103,6 +278,418 @@ void APIServerClass::_socketHandler(Socket *sock, AsyncWebServerRequest *req, Js
     (*out)["result"] = true;
 }
 
+void APIServerClass::_batchBody(AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t index, size_t total)
+{
+    /*
+     * Body is collected into the request temp object which is
+     * freed together with the request.
+     */
+
+    if (index == 0) {
+        if (total > API_BATCH_BODY_MAX) {
+            return;
+        }
+        req->_tempObject = malloc(total + 1);
+    }
+
+    if (req->_tempObject == nullptr || index + len > total) {
+        return;
+    }
+
+    memcpy((uint8_t *)req->_tempObject + index, data, len);
+    if (index + len == total) {
+        ((char *)req->_tempObject)[total] = '\0';
+    }
+}
+
+void APIServerClass::_batchHandler(AsyncWebServerRequest *req, JsonDocument *out)
+{
+    JsonDocument    jIn;
+    Socket          *socket;
+    ApiBatch        batch = {};
+
+    if (req->_tempObject == nullptr) {
+        _sendError(out, F("Batch body is empty or too large"));
+        return;
+    }
+
+    if (deserializeJson(jIn, (const char *)req->_tempObject) != DeserializationError::Ok || !jIn.is<JsonArray>()) {
+        _sendError(out, F("Batch body must be a JSON array"));
+        return;
+    }
+
+    if (jIn.as<JsonArray>().size() > API_BATCH_OPS_MAX) {
+        _sendError(out, F("Too many operations in batch"));
+        return;
+    }
+
+    /*
+     * Operations are only validated here, sockets are switched by
+     * the main loop. The client polls the batch id for completion.
+     */
+
+    for (JsonObject op : jIn.as<JsonArray>()) {
+        JsonObject  item = (*out)[F("items")].add<JsonObject>();
+
+        socket = nullptr;
+        if (op[F("id")].is<size_t>()) {
+            size_t id = op[F("id")].as<size_t>();
+
+            item[F("id")] = id;
+            if (id == 0 || !SocketCtrl.getSocket(id - 1, &socket) || !socket->enabled) {
+                socket = nullptr;
+            }
+        } else if (op[F("name")].is<const char *>()) {
+            item[F("name")] = op[F("name")].as<const char *>();
+            SocketCtrl.getSocket(op[F("name")].as<String>(), &socket);
+        }
+
+        if (socket == nullptr) {
+            item[F("result")] = false;
+            item[F("error")] = F("Socket not found");
+            continue;
+        }
+
+        if (op[F("status")].is<bool>()) {
+            batch.ops[batch.count].op = op[F("status")].as<bool>() ? API_SOCKET_ON : API_SOCKET_OFF;
+        } else if (op[F("status")] == "switch") {
+            batch.ops[batch.count].op = API_SOCKET_SWITCH;
+        } else {
+            item[F("result")] = false;
+            item[F("error")] = F("Unknown socket status");
+            continue;
+        }
+
+        batch.ops[batch.count].index = (uint8_t)(socket - SocketCtrl.getSockets()->data());
+        batch.count++;
+        item[F("result")] = true;
+    }
+
+    if (!_batchQueue(batch)) {
+        out->clear();
+        _sendError(out, F("Socket write queue is full"));
+        return;
+    }
+
+    (*out)[F("batch")] = batch.id;
+    (*out)[F("result")] = true;
+}
+
+void APIServerClass::_batchStatus(AsyncWebServerRequest *req, JsonDocument *out)
+{
+    uint32_t    id;
+    uint32_t    applied = __atomic_load_n(&_batchApplied, __ATOMIC_SEQ_CST);
+
+    if (req->getParam(F("id")) == nullptr) {
+        _sendError(out, F("Batch id is required"));
+        return;
+    }
+
+    id = strtoul(req->getParam(F("id"))->value().c_str(), nullptr, 10);
+    if (id == 0 || (int32_t)(id - _batchId) > 0) {
+        _sendError(out, F("Unknown batch id"));
+        return;
+    }
+
+    (*out)[F("batch")] = id;
+    (*out)[F("applied")] = ((int32_t)(applied - id) >= 0);
+    (*out)[F("result")] = true;
+}
+
+bool APIServerClass::_batchQueue(ApiBatch &batch)
+{
+    /*
+     * Only the async_tcp task queues writes, so the id counter
+     * needs no lock.
+     */
+
+    if (_batches == nullptr) {
+        return false;
+    }
+    batch.id = _batchId + 1;
+    if (xQueueSend(_batches, &batch, 0) != pdTRUE) {
+        return false;
+    }
+    _batchId = batch.id;
+    return true;
+}
+
+void APIServerClass::_batchApply()
+{
+    ApiBatch    batch;
+    Socket      *socket;
+
+    /*
+     * Sockets, extenders, GPIO and their batch state belong to the
+     * main loop, every API write is applied here as one batch.
+     */
+
+    while (xQueueReceive(_batches, &batch, 0) == pdTRUE) {
+        SocketCtrl.beginBatch();
+        for (size_t i = 0; i < batch.count; i++) {
+            if (!SocketCtrl.getSocket((size_t)batch.ops[i].index, &socket) || !socket->enabled) {
+                continue;
+            }
+            switch (batch.ops[i].op) {
+                case API_SOCKET_ON:
+                    SocketCtrl.setStatus(socket, true, true);
+                    break;
+
+                case API_SOCKET_OFF:
+                    SocketCtrl.setStatus(socket, false, true);
+                    break;
+
+                default:
+                    SocketCtrl.setStatus(socket, !socket->status, true);
+                    break;
+            }
+        }
+        SocketCtrl.commitBatch();
+
+        __atomic_store_n(&_batchApplied, batch.id, __ATOMIC_SEQ_CST);
+        Log.info(F("API"), String(F("Batch ")) + String(batch.id) + String(F(" applied to sockets: ")) +
+                           String(batch.count));
+    }
+}
+
+void APIServerClass::_gsmHandler(JsonDocument *out)
+{
+    (*out)[F("enabled")] = GsmModem.getEnabled();
+    (*out)[F("state")] = GsmModem.getStateName();
+    (*out)[F("ready")] = (GsmModem.getState() == GSM_STATE_READY);
+    (*out)[F("registration")] = GsmModem.getRegStatus(GsmModem.getRegistration());
+    (*out)[F("operator")] = GsmModem.getOperator();
+    (*out)[F("signal")] = GsmModem.getSignal();
+    (*out)[F("imei")] = GsmModem.getIMEI();
+    (*out)[F("ccid")] = GsmModem.getCCID();
+    if (GsmModem.getError() != "") {
+        (*out)[F("error")] = GsmModem.getError();
+    }
+    (*out)[F("result")] = true;
+}
+
+void APIServerClass::_sendJson(AsyncWebServerRequest *req, JsonDocument &doc, int code)
+{
+    AsyncResponseStream *res = req->beginResponseStream(F("application/json"));
+
+    res->setCode(code);
+    serializeJson(doc, *res);
+    req->send(res);
+}
+
+size_t APIServerClass::_sendChunk(ApiChunkState &state, uint8_t *buf, size_t maxLen, bool (APIServerClass::*next)(ApiChunkState &))
+{
+    size_t  written = 0;
+
+    while (written < maxLen) {
+        if (state.pos < state.len) {
+            size_t n = min(state.len - state.pos, maxLen - written);
+
+            memcpy(buf + written, state.item + state.pos, n);
+            state.pos += n;
+            written += n;
+            continue;
+        }
+
+        if (!(this->*next)(state)) {
+            break;
+        }
+    }
+
+    return written;
+}
+
+bool APIServerClass::_socketsNext(ApiChunkState &state)
+{
+    ApiWriter   writer(state.item, API_CHUNK_ITEM_MAX);
+    Socket      *socket;
+
+    switch (state.stage) {
+        case API_CHUNK_BEGIN:
+            writer.beginObject();
+            writer.add("version", (long)state.version);
+            writer.add("boot", String(state.boot, HEX).c_str());
+            writer.beginArray("sockets");
+            state.stage = API_CHUNK_ITEMS;
+            break;
+
+        case API_CHUNK_ITEMS:
+            /*
+             * Delta query returns only sockets changed after the given
+             * version, disabled ones included so clients can drop them.
+             */
+            while (SocketCtrl.getSocket(state.index, &socket)) {
+                if (state.since == 0 && socket->enabled) {
+                    break;
+                }
+                if (state.since > 0 && socket->version > state.since) {
+                    break;
+                }
+                state.index++;
+            }
+            if (!SocketCtrl.getSocket(state.index, &socket)) {
+                writer.endArray();
+                writer.add("result", true);
+                writer.endObject();
+                state.stage = API_CHUNK_END;
+                break;
+            }
+            if (state.count > 0) {
+                writer.comma();
+            }
+            /*
+             * Name is cut to leave room for the rest of the item, so
+             * the object is always closed.
+             */
+            writer.beginObject();
+            writer.add("name", socket->name.c_str(), API_CHUNK_NAME_MAX);
+            writer.add("status", socket->status);
+            if (state.since > 0) {
+                writer.add("enabled", socket->enabled);
+            }
+            writer.endObject();
+            state.index++;
+            state.count++;
+            break;
+
+        case API_CHUNK_END:
+            return false;
+    }
+
+    state.len = writer.length();
+    state.pos = 0;
+
+    return true;
+}
+
+bool APIServerClass::_metricsNext(ApiChunkState &state)
+{
+    int len;
+
+    while (state.index < API_METRIC_MAX) {
+        len = _metricsItem((ApiMetric)state.index, state.count, state.item, API_CHUNK_ITEM_MAX);
+        if (len > 0) {
+            state.len = min((size_t)len, (size_t)API_CHUNK_ITEM_MAX - 1);
+            state.pos = 0;
+            return true;
+        }
+        state.index++;
+        state.count = 0;
+    }
+
+    return false;
+}
+
+int APIServerClass::_metricsItem(ApiMetric metric, size_t &cursor, char *buf, size_t size)
+{
+    const MetricsLoop       &loop = Metrics.getLoop();
+    const MetricsOwSensor   *sensor;
+    const TgClientStats     &tg = TgBot.getClientStats();
+    I2cBus                  *bus;
+    Socket                  *socket;
+    const char              *name;
+    int                     len;
+    bool                    head = (cursor == 0);
+
+    /*
+     * Every call renders the next piece of one metric family and moves
+     * the cursor, zero means the family is done.
+     */
+
+    switch (metric) {
+        case API_METRIC_UPTIME:
+            if (cursor++ > 0) return 0;
+            return snprintf(buf, size,
+                "# TYPE plc_uptime_seconds counter\nplc_uptime_seconds %lu\n", millis() / 1000);
+
+        case API_METRIC_LOOPS:
+            if (cursor++ > 0) return 0;
+            return snprintf(buf, size,
+                "# TYPE plc_loop_total counter\nplc_loop_total %u\n", loop.count);
+
+        case API_METRIC_LOOP_TIME:
+            if (cursor++ > 0) return 0;
+            return snprintf(buf, size,
+                "# TYPE plc_loop_time_us gauge\n"
+                "plc_loop_time_us{stat=\"last\"} %u\n"
+                "plc_loop_time_us{stat=\"max\"} %u\n"
+                "plc_loop_time_us{stat=\"avg\"} %llu\n",
+                loop.last, loop.max, (loop.count > 0) ? loop.total / loop.count : 0);
+
+        case API_METRIC_HEAP:
+            if (cursor++ > 0) return 0;
+            return snprintf(buf, size,
+                "# TYPE plc_heap_bytes gauge\n"
+                "plc_heap_bytes{stat=\"free\"} %u\n"
+                "plc_heap_bytes{stat=\"min_free\"} %u\n"
+                "plc_heap_bytes{stat=\"largest_block\"} %u\n",
+                (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(), (unsigned)ESP.getMaxAllocHeap());
+
+        case API_METRIC_I2C_TRANSACTIONS:
+        case API_METRIC_I2C_ERRORS:
+            name = (metric == API_METRIC_I2C_TRANSACTIONS) ? "plc_i2c_transactions_total" : "plc_i2c_errors_total";
+            len = head ? snprintf(buf, size, "# TYPE %s counter\n", name) : 0;
+            if (!I2C.getI2cBus(cursor++, &bus)) {
+                return len;
+            }
+            return len + snprintf(buf + len, size - len, "%s{bus=\"%u\"} %u\n", name, bus->id,
+                (metric == API_METRIC_I2C_TRANSACTIONS) ? bus->transactions : bus->errors);
+
+        case API_METRIC_OW_READS:
+        case API_METRIC_OW_FAILS:
+            name = (metric == API_METRIC_OW_READS) ? "plc_onewire_reads_total" : "plc_onewire_failures_total";
+            len = head ? snprintf(buf, size, "# TYPE %s counter\n", name) : 0;
+            if (!Metrics.getOwSensor(cursor++, &sensor)) {
+                return len;
+            }
+            return len + snprintf(buf + len, size - len, "%s{sensor=\"%08lx%08lx\"} %u\n", name,
+                (unsigned long)(sensor->id >> 32), (unsigned long)(sensor->id & 0xffffffff),
+                (metric == API_METRIC_OW_READS) ? sensor->reads : sensor->fails);
+
+        case API_METRIC_SOCKET_TOGGLES:
+            name = "plc_socket_toggles_total";
+            len = head ? snprintf(buf, size, "# TYPE %s counter\n", name) : 0;
+            while (SocketCtrl.getSocket(cursor, &socket) && !socket->enabled) {
+                cursor++;
+            }
+            if (!SocketCtrl.getSocket(cursor++, &socket)) {
+                return len;
+            }
+            return len + snprintf(buf + len, size - len, "%s{id=\"%u\"} %u\n", name,
+                (unsigned)socket->id, socket->toggles);
+
+        case API_METRIC_WIFI_RSSI:
+            if (cursor++ > 0 || Wireless.getStatus() != WL_CONNECTED) return 0;
+            return snprintf(buf, size,
+                "# TYPE plc_wifi_rssi_dbm gauge\nplc_wifi_rssi_dbm %d\n", WiFi.RSSI());
+
+        case API_METRIC_WIFI_DROPS:
+            if (cursor++ > 0) return 0;
+            return snprintf(buf, size,
+                "# TYPE plc_wifi_drops_total counter\nplc_wifi_drops_total %u\n", Wireless.getStats().drops);
+
+        case API_METRIC_WIFI_RECONNECTS:
+            if (cursor++ > 0) return 0;
+            return snprintf(buf, size,
+                "# TYPE plc_wifi_reconnects_total counter\nplc_wifi_reconnects_total %u\n", Wireless.getStats().reconnects);
+
+        case API_METRIC_TG_LATENCY:
+            if (cursor++ > 0) return 0;
+            return snprintf(buf, size,
+                "# TYPE plc_telegram_request_latency_ms summary\n"
+                "plc_telegram_request_latency_ms_sum %u\n"
+                "plc_telegram_request_latency_ms_count %u\n"
+                "# TYPE plc_telegram_last_latency_ms gauge\n"
+                "plc_telegram_last_latency_ms %u\n",
+                tg.totalLatency, tg.requests, tg.lastLatency);
+
+        default:
+            break;
+    }
+
+    return 0;
+}
+
 void APIServerClass::_sendError(JsonDocument *out, const String &msg)
 {
     (*out)[F("result")] = false;
@@ -110,4 +697,173 @@ void APIServerClass::_sendError(JsonDocument *out, const String &msg)
     Log.error(F("API"), msg);
 }
 
+void APIServerClass::_wsEvent(AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len)
+{
+    bool    found = false;
+
+    /*
+     * Called from the TCP task, slots are shared with the main loop
+     */
+
+    xSemaphoreTake(_wsLock, portMAX_DELAY);
+
+    switch (type) {
+        case WS_EVT_CONNECT:
+            for (size_t i = 0; i < API_WS_CLIENTS_MAX; i++) {
+                if (!_wsClients[i].used) {
+                    _wsClients[i].id = client->id();
+                    _wsClients[i].used = true;
+                    _wsClients[i].resync = true;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                _wsStats.rejected++;
+                client->close();
+            }
+            break;
+
+        case WS_EVT_DISCONNECT:
+            for (size_t i = 0; i < API_WS_CLIENTS_MAX; i++) {
+                if (_wsClients[i].used && _wsClients[i].id == client->id()) {
+                    _wsClients[i].used = false;
+                }
+            }
+            break;
+
+        case WS_EVT_DATA:
+            /*
+             * Any message from the client requests a full snapshot
+             */
+            for (size_t i = 0; i < API_WS_CLIENTS_MAX; i++) {
+                if (_wsClients[i].used && _wsClients[i].id == client->id()) {
+                    _wsClients[i].resync = true;
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    xSemaphoreGive(_wsLock);
+}
+
+void APIServerClass::_wsMark(size_t slot, uint32_t id, bool resync)
+{
+    xSemaphoreTake(_wsLock, portMAX_DELAY);
+    if (_wsClients[slot].used && _wsClients[slot].id == id) {
+        _wsClients[slot].resync = resync;
+    }
+    xSemaphoreGive(_wsLock);
+}
+
+void APIServerClass::_wsFlush()
+{
+    uint32_t                version = Plc.getVersion();
+    size_t                  deltaLen = 0;
+    size_t                  fullLen = 0;
+    ApiWsClient             slot;
+    AsyncWebSocketClient    *client;
+
+    _ws.cleanupClients(API_WS_CLIENTS_MAX);
+
+    for (size_t i = 0; i < API_WS_CLIENTS_MAX; i++) {
+        xSemaphoreTake(_wsLock, portMAX_DELAY);
+        slot = _wsClients[i];
+        xSemaphoreGive(_wsLock);
+
+        if (!slot.used) {
+            continue;
+        }
+
+        client = _ws.client(slot.id);
+        if (client == nullptr || client->status() != WS_CONNECTED) {
+            continue;
+        }
+
+        /*
+         * Slow client with a full queue skips deltas and gets
+         * a full snapshot once it drains.
+         */
+
+        if (client->queueIsFull()) {
+            if (!slot.resync) {
+                _wsStats.skipped++;
+                _wsMark(i, slot.id, true);
+            }
+            continue;
+        }
+
+        if (!slot.resync && version != _wsVersion) {
+            if (deltaLen == 0) {
+                deltaLen = _wsState(_wsDelta, false, version);
+            }
+            if (deltaLen > 0) {
+                client->text(_wsDelta, deltaLen);
+                _wsStats.deltas++;
+                continue;
+            }
+            slot.resync = true;
+        }
+
+        if (slot.resync) {
+            if (fullLen == 0) {
+                fullLen = _wsState(_wsFull, true, version);
+            }
+            if (fullLen > 0) {
+                client->text(_wsFull, fullLen);
+                _wsStats.snapshots++;
+                _wsMark(i, slot.id, false);
+            }
+        }
+    }
+
+    _wsVersion = version;
+}
+
+size_t APIServerClass::_wsState(char *buf, bool full, uint32_t version)
+{
+    ApiWriter   writer(buf, API_WS_MSG_MAX);
+    Socket      *socket;
+
+    writer.beginObject();
+    writer.add("v", (long)version);
+    if (full) {
+        writer.add("full", true);
+    }
+    writer.add("alarm", (long)Plc.getAlarm());
+    writer.add("temp", Plc.getBoardTemp(), 1);
+    writer.add("fan", Plc.getFanStatus());
+    writer.beginArray("sockets");
+
+    for (size_t i = 0; SocketCtrl.getSocket(i, &socket); i++) {
+        if (full && !socket->enabled) {
+            continue;
+        }
+        if (!full && socket->version <= _wsVersion) {
+            continue;
+        }
+        writer.beginObject();
+        writer.add("id", (long)socket->id);
+        if (full) {
+            writer.add("name", socket->name.c_str());
+        } else {
+            writer.add("enabled", socket->enabled);
+        }
+        writer.add("status", socket->status);
+        writer.endObject();
+    }
+
+    writer.endArray();
+    writer.endObject();
+
+    if (writer.overflow()) {
+        return 0;
+    }
+
+    return writer.length();
+}
+
 APIServerClass APIServer(API_SERVER_DEFAULT_PORT);
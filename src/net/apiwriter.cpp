@@ -0,0 +1,235 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "net/apiwriter.hpp"
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+ApiWriter::ApiWriter(char *buf, size_t size) : _buf(buf), _size(size)
+{
+    reset();
+}
+
+void ApiWriter::reset()
+{
+    _len = 0;
+    _overflow = false;
+    _comma = false;
+    if (_size > 0) {
+        _buf[0] = '\0';
+    }
+}
+
+void ApiWriter::beginObject(const char *key)
+{
+    _key(key);
+    _char('{');
+    _comma = false;
+}
+
+void ApiWriter::endObject()
+{
+    _char('}');
+    _comma = true;
+}
+
+void ApiWriter::beginArray(const char *key)
+{
+    _key(key);
+    _char('[');
+    _comma = false;
+}
+
+void ApiWriter::endArray()
+{
+    _char(']');
+    _comma = true;
+}
+
+void ApiWriter::add(const char *key, const char *value)
+{
+    _key(key);
+    _string(value);
+    _comma = true;
+}
+
+void ApiWriter::add(const char *key, const char *value, size_t limit)
+{
+    _key(key);
+    _string(value, limit);
+    _comma = true;
+}
+
+void ApiWriter::add(const char *key, bool value)
+{
+    _key(key);
+    _raw(value ? "true" : "false");
+    _comma = true;
+}
+
+void ApiWriter::add(const char *key, long value)
+{
+    char num[12];
+
+    snprintf(num, sizeof(num), "%ld", value);
+    _key(key);
+    _raw(num);
+    _comma = true;
+}
+
+void ApiWriter::add(const char *key, float value, unsigned digits, size_t keyLimit)
+{
+    char num[24];
+
+    /*
+     * Failed sensor reads are NaN, which JSON cannot carry
+     */
+
+    if (isnan(value) || isinf(value)) {
+        strcpy(num, "null");
+    } else {
+        snprintf(num, sizeof(num), "%.*f", digits, value);
+    }
+    _key(key, keyLimit);
+    _raw(num);
+    _comma = true;
+}
+
+void ApiWriter::comma()
+{
+    _comma = true;
+}
+
+size_t ApiWriter::length() const
+{
+    return _len;
+}
+
+bool ApiWriter::overflow() const
+{
+    return _overflow;
+}
+
+const char *ApiWriter::c_str() const
+{
+    return _buf;
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void ApiWriter::_key(const char *key, size_t limit)
+{
+    if (_comma) {
+        _char(',');
+        _comma = false;
+    }
+    if (key != nullptr) {
+        _string(key, limit);
+        _char(':');
+    }
+}
+
+void ApiWriter::_char(char c)
+{
+    if (_len + 1 >= _size) {
+        _overflow = true;
+        return;
+    }
+    _buf[_len++] = c;
+    _buf[_len] = '\0';
+}
+
+void ApiWriter::_raw(const char *str)
+{
+    while (*str != '\0') {
+        _char(*str++);
+    }
+}
+
+void ApiWriter::_string(const char *str, size_t limit)
+{
+    size_t  start = _len;
+
+    /*
+     * Limit counts output bytes with quotes. The value is cut before a
+     * character that does not fit, never inside a UTF-8 sequence.
+     */
+
+    _char('"');
+    for (; *str != '\0'; str++) {
+        uint8_t c = *str;
+        size_t  need = 1;
+
+        if (c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t') {
+            need = 2;
+        } else if (c < 0x20) {
+            need = 6;
+        } else if ((c & 0xE0) == 0xC0) {
+            need = 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            need = 3;
+        } else if ((c & 0xF8) == 0xF0) {
+            need = 4;
+        }
+        if (limit != SIZE_MAX && _len - start + need + 1 > limit) {
+            break;
+        }
+
+        if (c >= 0x80) {
+            size_t i = 0;
+
+            for (; i < need && str[i] != '\0'; i++) {
+                _char(str[i]);
+            }
+            str += i - 1;
+            continue;
+        }
+
+        switch (*str) {
+            case '"':
+            case '\\':
+                _char('\\');
+                _char(*str);
+                break;
+
+            case '\n':
+                _raw("\\n");
+                break;
+
+            case '\r':
+                _raw("\\r");
+                break;
+
+            case '\t':
+                _raw("\\t");
+                break;
+
+            default:
+                if ((uint8_t)*str < 0x20) {
+                    char esc[7];
+                    snprintf(esc, sizeof(esc), "\\u%04x", *str);
+                    _raw(esc);
+                } else {
+                    _char(*str);
+                }
+                break;
+        }
+    }
+    _char('"');
+}
@@ -10,6 +10,8 @@
 /**********************************************************************/
 
 #include "net/core/gsm.hpp"
+#include "core/plc.hpp"
+#include "boards/boards.hpp"
 
 /*********************************************************************/
 /*                                                                   */
@@ -19,7 +21,20 @@
 
 GsmModemClass::GsmModemClass()
 {
-    _modem = new TinyGsm(_gsmUart);
+    addUrc(F("+CREG:"), [this](const String &line) {
+        _parseReg(line);
+        if (_state == GSM_STATE_READY && _regStatus != GSM_REG_OK_HOME && _regStatus != GSM_REG_OK_ROAMING) {
+            Log.warning(F("GSM"), F("Network registration lost"));
+            Plc.setAlarm(PLC_MOD_GSM, true);
+            _setState(GSM_STATE_REGISTRATION);
+        }
+    });
+    addUrc(F("NORMAL POWER DOWN"), [this](const String &line) {
+        _fail(F("Modem powered down"));
+    });
+    addUrc(F("UNDER-VOLTAGE POWER DOWN"), [this](const String &line) {
+        _fail(F("Modem powered down by under-voltage"));
+    });
 }
 
 void GsmModemClass::setUart(UARTClass *uart)
@@ -42,61 +57,223 @@ UARTClass *GsmModemClass::getUart() const
     return _uart;
 }
 
+GsmState GsmModemClass::getState() const
+{
+    return _state;
+}
+
+String GsmModemClass::getStateName() const
+{
+    switch (_state)
+    {
+        case GSM_STATE_OFF:
+            return F("Off");
+        case GSM_STATE_POWER:
+            return F("Power");
+        case GSM_STATE_RESET:
+            return F("Reset");
+        case GSM_STATE_AT_SYNC:
+            return F("AT sync");
+        case GSM_STATE_SIM:
+            return F("SIM");
+        case GSM_STATE_REGISTRATION:
+            return F("Registration");
+        case GSM_STATE_SIGNAL:
+            return F("Signal");
+        case GSM_STATE_READY:
+            return F("Ready");
+        case GSM_STATE_FAILED:
+            return F("Failed");
+    }
+    return F("Unknown");
+}
+
+bool GsmModemClass::isReady() const
+{
+    return (_state == GSM_STATE_READY);
+}
+
+GsmRegStatus GsmModemClass::getRegistration() const
+{
+    return _regStatus;
+}
+
+int GsmModemClass::getSignal() const
+{
+    return _signal;
+}
+
+const String &GsmModemClass::getOperator() const
+{
+    return _operator;
+}
+
+const String &GsmModemClass::getIMEI() const
+{
+    return _imei;
+}
+
+const String &GsmModemClass::getCCID() const
+{
+    return _ccid;
+}
+
+const String &GsmModemClass::getError() const
+{
+    return _error;
+}
+
+const GsmAtStats &GsmModemClass::getAtStats() const
+{
+    return _atStats;
+}
+
+size_t GsmModemClass::getQueueSize() const
+{
+    return _queue.size();
+}
+
+bool GsmModemClass::sendAT(const String &cmd, GsmAtCallback cb, unsigned timeout, const String &payload)
+{
+    if (_queue.size() >= GSM_AT_QUEUE_LEN) {
+        _atStats.dropped++;
+        return false;
+    }
+
+    _queue.push_back({ .cmd = cmd, .payload = payload, .timeout = timeout, .cb = cb });
+    return true;
+}
+
+void GsmModemClass::addUrc(const String &prefix, GsmUrcCallback cb)
+{
+    _urcs.push_back({ .prefix = prefix, .cb = cb });
+}
+
+void GsmModemClass::addRecipient(const String &phone)
+{
+    _recipients.push_back(phone);
+}
+
+void GsmModemClass::clearRecipients()
+{
+    _recipients.clear();
+}
+
+const std::vector<String> &GsmModemClass::getRecipients() const
+{
+    return _recipients;
+}
+
+bool GsmModemClass::sendAlert(const String &text)
+{
+    GsmAlertMsg msg;
+
+    if (!_enabled || _alerts == nullptr || _recipients.empty()) {
+        return false;
+    }
+
+    strncpy(msg.text, text.c_str(), GSM_SMS_EVENT_LEN - 1);
+    msg.text[GSM_SMS_EVENT_LEN - 1] = '\0';
+
+    if (xQueueSend(_alerts, &msg, 0) != pdTRUE) {
+        _smsStats.dropped++;
+        return false;
+    }
+
+    return true;
+}
+
+const GsmSmsStats &GsmModemClass::getSmsStats() const
+{
+    return _smsStats;
+}
+
+size_t GsmModemClass::getSmsQueueSize() const
+{
+    return _smsQueue.size();
+}
+
 void GsmModemClass::begin()
 {
     if (!_enabled) return;
 
     Log.info(F("GSM"), F("Starting GSM modem"));
-    //_gsmUart.begin(_uart->getRate(), SWSERIAL_8N1, _uart->getPin(UART_PIN_RX), _uart->getPin(UART_PIN_TX));
-    _modem->restart();
 
-    Log.info(F("GSM"), String(F("Modem Info: ")) + _modem->getModemInfo());
+    /*
+     * Modem bring-up is stepped from loop() through the AT queue, so
+     * boot and the main loop never wait for the modem.
+     */
 
-    if (_modem->getSimStatus() != SIM_READY) {
-        Log.error(F("GSM"), F("SIM not ready"));
-        return;
-    } else {
-        Log.info(F("GSM"), F("SIM is ready"));
-    }
-    
-    if (!_modem->waitForNetwork()) 
-    {
-        Log.error(F("GSM"), F("Failed to connect to network"));
-        return;
+    _alerts = xQueueCreate(GSM_SMS_ALERTS_QUEUE, sizeof(GsmAlertMsg));
+    _smsLoad();
+    _setState(GSM_STATE_POWER);
+}
+
+void GsmModemClass::loop()
+{
+    if (!_enabled) return;
+
+    if (_gsmUart != nullptr) {
+        _atRead();
     }
-    else
-    {
-        auto regStatus = _modem->getRegistrationStatus();
-        Log.info(F("GSM"), String(F("Registration : ")) + getRegStatus(regStatus));
-        Log.info(F("GSM"), String(F("CCID         : ")) + _modem->getSimCCID());
-        Log.info(F("GSM"), String(F("IMEI         : ")) + _modem->getIMEI());
-        Log.info(F("GSM"), String(F("Operator     : ")) + _modem->getOperator());
-        Log.info(F("GSM"), String(F("Signal       : ")) + getSigLevel(_modem->getSignalQuality()));
+    _smsLoop();
+
+    switch (_state) {
+        case GSM_STATE_POWER:
+            _stepPower();
+            break;
+
+        case GSM_STATE_RESET:
+            _stepReset();
+            break;
+
+        case GSM_STATE_AT_SYNC:
+            _stepSync();
+            break;
+
+        case GSM_STATE_SIM:
+            _stepSim();
+            break;
+
+        case GSM_STATE_REGISTRATION:
+            _stepRegistration();
+            break;
+
+        case GSM_STATE_SIGNAL:
+            _stepSignal();
+            break;
+
+        case GSM_STATE_READY:
+            _stepReady();
+            break;
+
+        case GSM_STATE_FAILED:
+            if (millis() - _timerState >= GSM_RETRY_DELAY_MS) {
+                Log.info(F("GSM"), F("Retrying modem initialization"));
+                _setState(GSM_STATE_RESET);
+            }
+            break;
+
+        default:
+            break;
     }
 }
 
-/*********************************************************************/
-/*                                                                   */
-/*                          PRIVATE FUNCTIONS                        */
-/*                                                                   */
-/*********************************************************************/
-
-String GsmModemClass::getRegStatus(const SIM800RegStatus state) const
+String GsmModemClass::getRegStatus(const GsmRegStatus state) const
 {
     switch (state)
     {
-        case REG_UNREGISTERED:
+        case GSM_REG_UNREGISTERED:
             return F("Not registered, MT is not currently searching");
-        case REG_SEARCHING:
-            return F("Not registered, MT is not currently searching");
-        case REG_DENIED:
+        case GSM_REG_SEARCHING:
+            return F("Not registered, MT is currently searching");
+        case GSM_REG_DENIED:
             return F("Registration denied");
-        case REG_OK_HOME:
+        case GSM_REG_OK_HOME:
             return F("Registered, home network");
-        case REG_OK_ROAMING:
+        case GSM_REG_OK_ROAMING:
             return F("Registered, roaming");
-        case REG_UNKNOWN:
-        case REG_NO_RESULT:
+        case GSM_REG_UNKNOWN:
             return F("Unknown");
     }
     return F("Unknown");
@@ -121,4 +298,652 @@ String GsmModemClass::getSigLevel(int level) const
     return F("Unknown");
 }
 
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void GsmModemClass::_setState(GsmState state)
+{
+    _state = state;
+    _timerState = millis();
+    _timerStep = 0;
+}
+
+void GsmModemClass::_fail(const String &error)
+{
+    _error = error;
+    Log.error(F("GSM"), error);
+    Plc.setAlarm(PLC_MOD_GSM, true);
+    _setState(GSM_STATE_FAILED);
+}
+
+bool GsmModemClass::_stepAT(const String &cmd, GsmAtCallback cb)
+{
+    GsmState    state = _state;
+
+    if (_stepBusy) return false;
+    if (_timerStep != 0 && millis() - _timerStep < GSM_STEP_DELAY_MS) return false;
+
+    _timerStep = millis();
+    _stepBusy = sendAT(cmd, [this, state, cb](bool ok, const String &resp) {
+        _stepBusy = false;
+        if (_state == state) {
+            cb(ok, resp);
+        }
+    });
+
+    return _stepBusy;
+}
+
+void GsmModemClass::_stepPower()
+{
+    const ProfUART  &uart = ActiveBoard.interfaces.uart[0];
+
+    /*
+     * Hardware UART driver keeps RX in its own ring buffer filled from
+     * the ISR, so modem traffic costs no CPU between AT commands.
+     */
+
+    if (_timerStep == 0) {
+        if (_gsmUart == nullptr) {
+            _gsmUart = new HardwareSerial(uart.id);
+            _gsmUart->setRxBufferSize(GSM_UART_RX_BUF);
+            _gsmUart->begin(uart.speed, SERIAL_8N1, uart.rx, uart.tx);
+            Log.info(F("GSM"), String(F("Modem at UART")) + String(uart.id) +
+                    String(F(" speed: ")) + String(uart.speed));
+        }
+        _timerStep = millis();
+        return;
+    }
+
+    if (millis() - _timerState >= GSM_POWER_DELAY_MS) {
+        _setState(GSM_STATE_AT_SYNC);
+    }
+}
+
+void GsmModemClass::_stepReset()
+{
+    std::vector<GsmAtCmd> queue;
+
+    /*
+     * A hung modem is restarted with a full functionality reset. The
+     * board has no PWRKEY line, so the command goes out past the queue,
+     * after ESC in case the modem sits in text entry.
+     */
+
+    if (_timerStep == 0) {
+        if (_busy) {
+            _atDone(false);
+        }
+        queue.swap(_queue);
+        for (auto &cmd : queue) {
+            if (cmd.cb) {
+                cmd.cb(false, "");
+            }
+        }
+
+        Log.warning(F("GSM"), F("Resetting modem"));
+        _gsmUart->write(0x1B);
+        _gsmUart->print(F("AT+CFUN=1,1\r"));
+        _atStats.sent++;
+        _timerStep = millis();
+        return;
+    }
+
+    if (millis() - _timerState >= GSM_RESET_DELAY_MS) {
+        while (_gsmUart->read() >= 0);
+        _line = "";
+        _escape = false;
+        _setState(GSM_STATE_AT_SYNC);
+    }
+}
+
+void GsmModemClass::_stepSync()
+{
+    _stepAT(F("E0"), [this](bool ok, const String &resp) {
+        if (!ok) return;
+        Log.info(F("GSM"), F("Modem is responding"));
+        sendAT(F("+CREG=1"));
+        sendAT(F("+CMGF=1;+CSMP=17,167,0,8"));
+        _setState(GSM_STATE_SIM);
+    });
+
+    if (_state == GSM_STATE_AT_SYNC && millis() - _timerState >= GSM_SYNC_TIMEOUT_MS) {
+        _fail(F("Modem is not responding"));
+    }
+}
+
+void GsmModemClass::_stepSim()
+{
+    _stepAT(F("+CPIN?"), [this](bool ok, const String &resp) {
+        if (resp.indexOf(F("READY")) >= 0) {
+            Log.info(F("GSM"), F("SIM is ready"));
+            _setState(GSM_STATE_REGISTRATION);
+        } else if (resp.indexOf(F("SIM PIN")) >= 0 || resp.indexOf(F("SIM PUK")) >= 0) {
+            _fail(F("SIM is locked"));
+        }
+    });
+
+    if (_state == GSM_STATE_SIM && millis() - _timerState >= GSM_SIM_TIMEOUT_MS) {
+        _fail(F("SIM not ready"));
+    }
+}
+
+void GsmModemClass::_stepRegistration()
+{
+    _stepAT(F("+CREG?"), [this](bool ok, const String &resp) {
+        _parseStatus(resp);
+
+        switch (_regStatus) {
+            case GSM_REG_OK_HOME:
+            case GSM_REG_OK_ROAMING:
+                Log.info(F("GSM"), String(F("Registration : ")) + getRegStatus(_regStatus));
+                _setState(GSM_STATE_SIGNAL);
+                break;
+
+            case GSM_REG_DENIED:
+                _fail(F("Registration denied"));
+                break;
+
+            default:
+                break;
+        }
+    });
+
+    if (_state == GSM_STATE_REGISTRATION && millis() - _timerState >= GSM_REG_TIMEOUT_MS) {
+        _fail(F("Failed to connect to network"));
+    }
+}
+
+void GsmModemClass::_stepSignal()
+{
+    _stepAT(F("+CSQ;+COPS?"), [this](bool ok, const String &resp) {
+        _parseStatus(resp);
+
+        if (_signal == 99 && millis() - _timerState < GSM_SIGNAL_TIMEOUT_MS) return;
+
+        if (_imei == "") {
+            sendAT(F("+GSN"), [this](bool ok, const String &resp) {
+                if (ok) { _imei = resp; }
+            });
+        }
+        sendAT(F("+CCID"), [this](bool ok, const String &resp) {
+            if (ok) { _ccid = resp; }
+        });
+
+        _error = "";
+
+        Log.info(F("GSM"), String(F("Operator     : ")) + _operator);
+        Log.info(F("GSM"), String(F("Signal       : ")) + getSigLevel(_signal));
+
+        Plc.setAlarm(PLC_MOD_GSM, false);
+        _setState(GSM_STATE_READY);
+    });
+}
+
+void GsmModemClass::_stepReady()
+{
+    if (millis() - _timerState < GSM_POLL_DELAY_MS) return;
+    _timerState = millis();
+
+    /*
+     * One batched poll refreshes signal, registration and operator
+     */
+
+    _stepAT(F("+CSQ;+CREG?;+COPS?"), [this](bool ok, const String &resp) {
+        if (!ok) return;
+
+        _parseStatus(resp);
+        if (_regStatus != GSM_REG_OK_HOME && _regStatus != GSM_REG_OK_ROAMING) {
+            Log.warning(F("GSM"), F("Network registration lost"));
+            Plc.setAlarm(PLC_MOD_GSM, true);
+            _setState(GSM_STATE_REGISTRATION);
+        }
+    });
+}
+
+void GsmModemClass::_atRead()
+{
+    while (_gsmUart->available()) {
+        char c = _gsmUart->read();
+
+        _atStats.rxBytes++;
+        if (c == '\r') continue;
+        if (c == '\n') {
+            if (_line.length() > 0) {
+                _atLine(_line);
+            }
+            _line = "";
+            continue;
+        }
+
+        if (_line.length() < GSM_AT_LINE_MAX) {
+            _line += c;
+        }
+
+        /*
+         * Data prompt is not terminated with a newline. A prompt nobody
+         * waits for any more is cancelled, otherwise the next command
+         * would be taken as message text.
+         */
+
+        if (_line == "> ") {
+            if (_busy && _prompt) {
+                _gsmUart->print(_current.payload);
+                _gsmUart->write(0x1A);
+                _prompt = false;
+            } else {
+                _atEscape();
+            }
+            _line = "";
+        }
+    }
+
+    if (_busy && millis() - _timerCmd >= _current.timeout) {
+        Log.warning(F("GSM"), String(F("AT timeout: ")) + _current.cmd);
+        _atStats.timeouts++;
+        _atDone(false);
+    }
+
+    if (_escape && millis() - _timerEsc >= GSM_AT_ESC_DELAY_MS) {
+        _escape = false;
+    }
+
+    if (!_busy && !_escape && !_queue.empty()) {
+        _current = _queue.front();
+        _queue.erase(_queue.begin());
+        _resp = "";
+        _prompt = (_current.payload != "");
+        _busy = true;
+        _timerCmd = millis();
+        _atStats.sent++;
+
+        _gsmUart->print(F("AT"));
+        _gsmUart->print(_current.cmd);
+        _gsmUart->print('\r');
+    }
+}
+
+void GsmModemClass::_atLine(const String &line)
+{
+    if (_busy) {
+        if (line == F("OK")) {
+            _atDone(true);
+            return;
+        }
+        if (line == F("ERROR") || line.startsWith(F("+CME ERROR")) || line.startsWith(F("+CMS ERROR"))) {
+            _resp += line;
+            _atStats.failed++;
+            _atDone(false);
+            return;
+        }
+        if (line.startsWith(F("AT"))) {
+            return;
+        }
+    }
+
+    if (_atUrc(line)) {
+        return;
+    }
+
+    if (_busy) {
+        if (_resp.length() > 0) {
+            _resp += '\n';
+        }
+        _resp += line;
+    }
+}
+
+void GsmModemClass::_atDone(bool ok)
+{
+    GsmAtCallback   cb = _current.cb;
+    String          resp = _resp;
+
+    /*
+     * Modem may still sit in text entry after a failed payload command
+     */
+
+    if (!ok && _current.payload != "") {
+        _atEscape();
+    }
+
+    _busy = false;
+    _prompt = false;
+    _resp = "";
+
+    if (cb) {
+        cb(ok, resp);
+    }
+}
+
+void GsmModemClass::_atEscape()
+{
+    Log.warning(F("GSM"), F("Cancelling modem text entry"));
+    _gsmUart->write(0x1B);
+
+    /*
+     * Result of the cancelled command is dropped as a stray line
+     * before the next command goes out.
+     */
+
+    _escape = true;
+    _timerEsc = millis();
+}
+
+bool GsmModemClass::_atUrc(const String &line)
+{
+    for (auto &urc : _urcs) {
+        if (!line.startsWith(urc.prefix)) {
+            continue;
+        }
+
+        /*
+         * "+XXX:" lines are a reply when the current command asks for "+XXX"
+         */
+
+        if (_busy && urc.prefix.startsWith("+")) {
+            int pos = urc.prefix.indexOf(':');
+            String key = (pos > 0) ? urc.prefix.substring(0, pos) : urc.prefix;
+            if (_current.cmd.indexOf(key) >= 0) {
+                return false;
+            }
+        }
+
+        _atStats.urcs++;
+        urc.cb(line);
+        return true;
+    }
+
+    return false;
+}
+
+void GsmModemClass::_parseStatus(const String &resp)
+{
+    int start = 0;
+
+    while (start < (int)resp.length()) {
+        int end = resp.indexOf('\n', start);
+        if (end < 0) {
+            end = resp.length();
+        }
+
+        String line = resp.substring(start, end);
+        start = end + 1;
+
+        if (line.startsWith(F("+CSQ:"))) {
+            _signal = line.substring(line.indexOf(':') + 1).toInt();
+        } else if (line.startsWith(F("+CREG:"))) {
+            _parseReg(line);
+        } else if (line.startsWith(F("+COPS:"))) {
+            int first = line.indexOf('"');
+            int last = line.lastIndexOf('"');
+            _operator = (first >= 0 && last > first) ? line.substring(first + 1, last) : "";
+        }
+    }
+}
+
+void GsmModemClass::_parseReg(const String &line)
+{
+    String  value = line.substring(line.indexOf(':') + 1);
+    int     comma = value.indexOf(',');
+    int     stat;
+
+    /*
+     * Query reply is "+CREG: <n>,<stat>", URC is "+CREG: <stat>"
+     */
+
+    if (comma >= 0) {
+        value = value.substring(comma + 1);
+    }
+    value.trim();
+    stat = value.toInt();
+
+    if (stat < GSM_REG_UNREGISTERED || stat > GSM_REG_OK_ROAMING) {
+        _regStatus = GSM_REG_UNKNOWN;
+    } else {
+        _regStatus = (GsmRegStatus)stat;
+    }
+}
+
+void GsmModemClass::_smsLoop()
+{
+    GsmSms      *sms = nullptr;
+    GsmAlertMsg msg;
+    bool        dup;
+
+    /*
+     * Alerts come from any task through the queue, coalescing and
+     * the event list stay in the main loop.
+     */
+
+    while (_alerts != nullptr && xQueueReceive(_alerts, &msg, 0) == pdTRUE) {
+        dup = false;
+        for (auto &event : _smsEvents) {
+            if (event == msg.text) {
+                dup = true;
+                break;
+            }
+        }
+        if (dup) {
+            continue;
+        }
+        if (_smsEvents.size() >= GSM_SMS_EVENTS_MAX) {
+            _smsStats.dropped++;
+            continue;
+        }
+        if (_smsEvents.empty()) {
+            _timerCoalesce = millis();
+        }
+        _smsEvents.push_back(String(msg.text));
+    }
+
+    if (!_smsEvents.empty() && millis() - _timerCoalesce >= GSM_SMS_WINDOW_MS) {
+        _smsFlush();
+    }
+
+    if (_state != GSM_STATE_READY || _smsBusy || _smsQueue.empty()) return;
+
+    /*
+     * Keep well below operator limits: one SMS per interval and
+     * no more than GSM_SMS_HOUR_MAX per hour.
+     */
+
+    if (_timerSms != 0 && millis() - _timerSms < GSM_SMS_INTERVAL_MS) return;
+    if (millis() - _timerHour >= 3600000) {
+        _timerHour = millis();
+        _smsHourCount = 0;
+    }
+    if (_smsHourCount >= GSM_SMS_HOUR_MAX) return;
+
+    for (auto &msg : _smsQueue) {
+        if ((int)(millis() - msg.next) >= 0) {
+            sms = &msg;
+            break;
+        }
+    }
+
+    if (sms != nullptr) {
+        _smsSend(*sms);
+    }
+}
+
+void GsmModemClass::_smsFlush()
+{
+    String  text = Plc.getName() + ": ";
+
+    for (size_t i = 0; i < _smsEvents.size(); i++) {
+        if (i > 0) {
+            text += "; ";
+        }
+        text += _smsEvents[i];
+    }
+    _smsEvents.clear();
+
+    if (text.length() > EE_DB_SMS_TEXT_LEN) {
+        text = text.substring(0, EE_DB_SMS_TEXT_LEN);
+    }
+
+    for (auto &phone : _recipients) {
+        bool    found = false;
+
+        for (auto &msg : _smsQueue) {
+            if (msg.phone == phone && msg.text == text) {
+                found = true;
+                break;
+            }
+        }
+        if (found) continue;
+
+        if (_smsQueue.size() >= EE_DB_SMS_MAX) {
+            Log.warning(F("GSM"), String(F("SMS queue full, dropped message to: ")) + _smsQueue.front().phone);
+            _smsQueue.erase(_smsQueue.begin());
+            _smsStats.dropped++;
+        }
+
+        _smsQueue.push_back({ .phone = phone, .text = text, .tries = 0, .next = millis() });
+        _smsStats.queued++;
+    }
+
+    _smsSave();
+}
+
+void GsmModemClass::_smsSend(GsmSms &sms)
+{
+    String  phone = sms.phone;
+    String  text = sms.text;
+
+    /*
+     * Socket names are Cyrillic, GSM 7-bit cannot carry them. The text
+     * goes out as UCS2, the character set is switched back afterwards
+     * so other replies stay plain text.
+     */
+
+    if (_queue.size() + 3 > GSM_AT_QUEUE_LEN) {
+        return;
+    }
+
+    _smsBusy = true;
+    _timerSms = millis();
+    _smsHourCount++;
+
+    sendAT(F("+CSCS=\"UCS2\""));
+    _smsBusy = sendAT(String(F("+CMGS=\"")) + _ucs2(phone, EE_DB_PHONE_LEN) + "\"", [this, phone, text](bool ok, const String &resp) {
+        _smsBusy = false;
+
+        for (size_t i = 0; i < _smsQueue.size(); i++) {
+            GsmSms &msg = _smsQueue[i];
+
+            if (msg.phone != phone || msg.text != text) continue;
+
+            if (ok) {
+                Log.info(F("GSM"), String(F("SMS sent to: ")) + phone);
+                _smsQueue.erase(_smsQueue.begin() + i);
+                _smsStats.sent++;
+            } else if (++msg.tries >= GSM_SMS_RETRY_COUNT) {
+                Log.error(F("GSM"), String(F("Failed to send SMS to: ")) + phone);
+                _smsQueue.erase(_smsQueue.begin() + i);
+                _smsStats.failed++;
+            } else {
+                unsigned backoff = GSM_SMS_RETRY_MIN_MS << (msg.tries - 1);
+
+                msg.next = millis() + min(backoff, (unsigned)GSM_SMS_RETRY_MAX_MS);
+                Log.warning(F("GSM"), String(F("SMS to: ")) + phone + String(F(" failed, retry in ")) +
+                        String(min(backoff, (unsigned)GSM_SMS_RETRY_MAX_MS) / 1000) + String(F(" s")));
+            }
+            break;
+        }
+
+        _smsSave();
+    }, GSM_SMS_SEND_TIMEOUT_MS, _ucs2(text, GSM_SMS_UCS2_MAX));
+    sendAT(F("+CSCS=\"GSM\""));
+}
+
+String GsmModemClass::_ucs2(const String &text, size_t max) const
+{
+    String  hex;
+    size_t  count = 0;
+    size_t  i = 0;
+    char    buf[5];
+
+    /*
+     * UTF-8 to UTF-16 hex, characters outside the BMP and broken
+     * sequences left by byte truncation are skipped.
+     */
+
+    while (i < text.length() && count < max) {
+        uint8_t     c = text[i];
+        uint32_t    code;
+        size_t      len;
+
+        if (c < 0x80) {
+            code = c;
+            len = 1;
+        } else if ((c & 0xE0) == 0xC0) {
+            code = c & 0x1F;
+            len = 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            code = c & 0x0F;
+            len = 3;
+        } else {
+            i++;
+            continue;
+        }
+
+        if (i + len > text.length()) {
+            break;
+        }
+        for (size_t k = 1; k < len; k++) {
+            code = (code << 6) | (text[i + k] & 0x3F);
+        }
+        i += len;
+
+        snprintf(buf, sizeof(buf), "%04X", (unsigned)code);
+        hex += buf;
+        count++;
+    }
+    return hex;
+}
+
+void GsmModemClass::_smsLoad()
+{
+    EeDbSms     db;
+
+    if (!EeDb.getEnabled() || !EeDb.loadSmsDb(db)) {
+        return;
+    }
+
+    _smsQueue.clear();
+    for (uint8_t i = 0; i < db.count; i++) {
+        db.msgs[i].phone[EE_DB_PHONE_LEN - 1] = '\0';
+        db.msgs[i].text[EE_DB_SMS_TEXT_LEN] = '\0';
+        _smsQueue.push_back({ .phone = db.msgs[i].phone, .text = db.msgs[i].text,
+                            .tries = db.msgs[i].tries, .next = millis() });
+    }
+
+    if (db.count > 0) {
+        Log.info(F("GSM"), String(F("Restored SMS from EEPROM: ")) + String(db.count));
+    }
+}
+
+void GsmModemClass::_smsSave()
+{
+    EeDbSms     db;
+
+    if (!EeDb.getEnabled()) {
+        return;
+    }
+
+    memset(&db, 0x0, sizeof(EeDbSms));
+    db.count = _smsQueue.size();
+    for (size_t i = 0; i < _smsQueue.size(); i++) {
+        strncpy(db.msgs[i].phone, _smsQueue[i].phone.c_str(), EE_DB_PHONE_LEN - 1);
+        strncpy(db.msgs[i].text, _smsQueue[i].text.c_str(), EE_DB_SMS_TEXT_LEN);
+        db.msgs[i].tries = _smsQueue[i].tries;
+    }
+
+    EeDb.saveSmsDb(db);
+}
+
 GsmModemClass GsmModem;
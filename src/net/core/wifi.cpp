@@ -12,6 +12,8 @@
 #include "net/core/wifi.hpp"
 #include "core/plc.hpp"
 #include "boards/boards.hpp"
+#include "core/rtcstate.hpp"
+#include "db/eedb.h"
 
 /*********************************************************************/
 /*                                                                   */
@@ -82,6 +84,52 @@ String WirelessClass::getHostname()
     return WiFi.getHostname();
 }
 
+void WirelessClass::setFastConnect(bool status)
+{
+    _fastConnect = status;
+}
+
+bool &WirelessClass::getFastConnect()
+{
+    return _fastConnect;
+}
+
+void WirelessClass::setStaticIP(const IPAddress &ip, const IPAddress &subnet, const IPAddress &gateway, const IPAddress &dns)
+{
+    _ip = ip;
+    _subnet = subnet;
+    _gateway = gateway;
+    _dns = dns;
+    _static = true;
+}
+
+void WirelessClass::clearStaticIP()
+{
+    _static = false;
+}
+
+bool WirelessClass::getStaticIP(IPAddress &ip, IPAddress &subnet, IPAddress &gateway, IPAddress &dns) const
+{
+    if (!_static) {
+        return false;
+    }
+    ip = _ip;
+    subnet = _subnet;
+    gateway = _gateway;
+    dns = _dns;
+    return true;
+}
+
+const WiFiStats &WirelessClass::getStats() const
+{
+    return _stats;
+}
+
+WirelessState WirelessClass::getState() const
+{
+    return _state;
+}
+
 void WirelessClass::begin()
 {
     if (!_enabled) return;
@@ -96,8 +144,16 @@ void WirelessClass::begin()
     }
 
     if (!_ap) {
+        if (_events == nullptr) {
+            _events = xQueueCreate(WIFI_EVENTS_QUEUE_LEN, sizeof(WirelessEvtMsg));
+            _eventId = WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info) {
+                _onEvent(event, info);
+            });
+        }
         WiFi.mode(WIFI_STA);
-        WiFi.begin(_ssid, _passwd);
+        WiFi.setAutoReconnect(false);
+        _backoff = WIFI_BACKOFF_MIN_MS;
+        _connect(_fastConnect);
     } else {
         Log.info(F("WIFI"), String(F("Starting Wi-Fi AP: ")) + _ssid);
         WiFi.mode(WIFI_AP);
@@ -109,11 +165,39 @@ void WirelessClass::begin()
 
 void WirelessClass::loop()
 {
-    if (!_enabled) return;
+    WirelessEvtMsg  msg;
+
+    if (!_enabled || _ap || _events == nullptr) return;
+
+    while (xQueueReceive(_events, &msg, 0) == pdTRUE) {
+        _processEvent(msg);
+    }
+
+    switch (_state) {
+        case WIRELESS_STATE_CONNECTING:
+            if (_fastAttempt && millis() - _timerConnect >= WIFI_FAST_TIMEOUT_MS) {
+                Log.warning(F("WIFI"), F("Cached AP not available. Scanning for SSID"));
+                _stats.fallbacks++;
+                RtcState.clearWiFi();
+                _disconnect();
+                _connect(false);
+            } else if (millis() - _timerConnect >= WIFI_CONNECT_TIMEOUT_MS) {
+                Log.warning(F("WIFI"), String(F("Connect timeout to SSID: ")) + _ssid);
+                _disconnect();
+                Plc.setAlarm(PLC_MOD_WIFI, true);
+                _scheduleReconnect();
+            }
+            break;
 
-    if (millis() - _timer >= WIFI_DELAY_MS) {
-        _timer = millis();
-        statusTask();
+        case WIRELESS_STATE_BACKOFF:
+            if (millis() - _timerRetry >= _retryDelay) {
+                _stats.reconnects++;
+                _connect(_fastConnect);
+            }
+            break;
+
+        default:
+            break;
     }
 }
 
@@ -123,50 +207,240 @@ void WirelessClass::loop()
 /*                                                                   */
 /*********************************************************************/
 
-void WirelessClass::statusTask()
+void WirelessClass::_connect(bool fast)
 {
-    if (WiFi.status() != _status) {
-        _status = WiFi.status();
+    EeDbWiFi    cache;
+    uint8_t     channel = 0;
+    uint8_t     bssid[EE_DB_BSSID_LEN];
+    bool        cached = false;
+    bool        lease = false;
+
+    memset(&cache, 0x0, sizeof(EeDbWiFi));
 
-        switch (_status)
-        {
-        case WL_CONNECTED:
-            if (_statusLed != nullptr) { Gpio.write(_statusLed, true); }
-            Plc.setAlarm(PLC_MOD_WIFI, false);
-            Log.info(F("WIFI"), String(F("PLC was connected to SSID: ")) + _ssid);
-            Log.info(F("WIFI"), String(F("PLC IP address: ")) + getIP());
+    if (fast) {
+        if (RtcState.getWiFi(channel, bssid)) {
+            cached = true;
+        }
+        if (EeDb.getEnabled() && EeDb.loadWiFiDb(cache)) {
+            if (!cached && cache.channel != 0) {
+                channel = cache.channel;
+                memcpy(bssid, cache.bssid, EE_DB_BSSID_LEN);
+                cached = true;
+            }
+            lease = (cache.ip != 0);
+        }
+    }
+
+    /*
+     * A configured static IP always wins, the last DHCP lease is only
+     * reused on the fast path and dropped again on fallback.
+     */
+
+    if (_static) {
+        WiFi.config(_ip, _gateway, _subnet, _dns);
+    } else if (fast && lease) {
+        WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+    } else {
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    }
+
+    _fastAttempt = fast && cached;
+    _timerConnect = millis();
+    _state = WIRELESS_STATE_CONNECTING;
+
+    if (_fastAttempt) {
+        Log.info(F("WIFI"), String(F("Fast connect to cached AP at channel: ")) + String(channel));
+        WiFi.begin(_ssid.c_str(), _passwd.c_str(), channel, bssid);
+    } else {
+        WiFi.begin(_ssid, _passwd);
+    }
+}
+
+void WirelessClass::_saveCache()
+{
+    EeDbWiFi    cache;
+    EeDbWiFi    old;
+    uint8_t     *bssid = WiFi.BSSID();
+
+    if (bssid == nullptr) {
+        return;
+    }
+
+    RtcState.setWiFi(WiFi.channel(), bssid);
+
+    if (!EeDb.getEnabled()) {
+        return;
+    }
+
+    memset(&cache, 0x0, sizeof(EeDbWiFi));
+    cache.magic = EE_DB_WIFI_MAGIC;
+    cache.channel = WiFi.channel();
+    memcpy(cache.bssid, bssid, EE_DB_BSSID_LEN);
+    if (!_static) {
+        cache.ip = WiFi.localIP();
+        cache.subnet = WiFi.subnetMask();
+        cache.gateway = WiFi.gatewayIP();
+        cache.dns = WiFi.dnsIP();
+    }
+
+    if (EeDb.loadWiFiDb(old) && memcmp(&old, &cache, sizeof(EeDbWiFi)) == 0) {
+        return;
+    }
+
+    if (!EeDb.saveWiFiDb(cache)) {
+        Log.error(F("WIFI"), F("Failed to save connection cache to EEPROM"));
+    }
+}
+
+void WirelessClass::_onEvent(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+    WirelessEvtMsg  msg;
+
+    /*
+     * Called from the Wi-Fi driver task. GPIO may sit behind an I2C
+     * extender, so the event is only queued here and handled by loop().
+     */
+
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+            msg.type = WIRELESS_EVT_CONNECTED;
+            msg.reason = 0;
+            break;
+
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            msg.type = WIRELESS_EVT_GOT_IP;
+            msg.reason = 0;
             break;
 
-        case WL_CONNECTION_LOST:
-            if (_statusLed != nullptr) { Gpio.write(_statusLed, false); }
-            Plc.setAlarm(PLC_MOD_WIFI, true);
-            Log.info(F("WIFI"), String(F("PLC connection lost to SSID: ")) + _ssid);
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            msg.type = WIRELESS_EVT_LOST_IP;
+            msg.reason = 0;
             break;
 
-        case WL_IDLE_STATUS:
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            msg.type = WIRELESS_EVT_DISCONNECTED;
+            msg.reason = info.wifi_sta_disconnected.reason;
             break;
 
-        case WL_NO_SHIELD:
+        default:
+            return;
+    }
+
+    msg.time = millis();
+    xQueueSend(_events, &msg, 0);
+}
+
+void WirelessClass::_processEvent(const WirelessEvtMsg &msg)
+{
+    switch (msg.type) {
+        case WIRELESS_EVT_CONNECTED:
+            _leaving = false;
+            _state = WIRELESS_STATE_ASSOCIATED;
             break;
 
-        case WL_NO_SSID_AVAIL:
-            if (_statusLed != nullptr) { Gpio.write(_statusLed, false); }
-            Plc.setAlarm(PLC_MOD_WIFI, true);
-            Log.info(F("WIFI"), String(F("PLC no available SSID: ")) + _ssid);
+        case WIRELESS_EVT_GOT_IP:
+            _stats.lastTime = msg.time - _timerConnect;
+            _stats.lastFast = _fastAttempt;
+            if (_fastAttempt) {
+                _stats.fastCount++;
+                _stats.fastTime += _stats.lastTime;
+            } else {
+                _stats.fullCount++;
+                _stats.fullTime += _stats.lastTime;
+            }
+            _fastAttempt = false;
+            _backoff = WIFI_BACKOFF_MIN_MS;
+            _state = WIRELESS_STATE_ONLINE;
+            _status = WL_CONNECTED;
+            _saveCache();
+            _setOnline(true);
+            Log.info(F("WIFI"), String(F("Connected in ")) + String(_stats.lastTime) +
+                    String(_stats.lastFast ? F(" ms (fast)") : F(" ms (scan)")));
             break;
 
-        case WL_SCAN_COMPLETED:
-            if (_statusLed != nullptr) { Gpio.write(_statusLed, false); }
-            Plc.setAlarm(PLC_MOD_WIFI, true);
-            Log.info(F("WIFI"), String(F("PLC scan completed for SSID: ")) + _ssid);
+        case WIRELESS_EVT_LOST_IP:
+            if (_state == WIRELESS_STATE_ONLINE) {
+                _stats.drops++;
+                _status = WL_CONNECTION_LOST;
+                _setOnline(false);
+                _disconnect();
+                _scheduleReconnect();
+            }
             break;
-        
-        default:
-            if (_statusLed != nullptr) { Gpio.write(_statusLed, false); }
-            Plc.setAlarm(PLC_MOD_WIFI, true);
-            Log.info(F("WIFI"), String(F("PLC has been disconnected from SSID: ")) + _ssid);
+
+        case WIRELESS_EVT_DISCONNECTED:
+            /*
+             * Leave is reported for our own disconnect() calls, but an
+             * AP restart sends the same reason, so only ours are skipped.
+             */
+            if (_leaving && msg.reason == WIFI_REASON_ASSOC_LEAVE) {
+                _leaving = false;
+                break;
+            }
+
+            _stats.lastReason = msg.reason;
+
+            if (_state == WIRELESS_STATE_ONLINE) {
+                _stats.drops++;
+                _status = WL_CONNECTION_LOST;
+                _setOnline(false);
+                Log.info(F("WIFI"), String(F("PLC connection lost to SSID: ")) + _ssid +
+                        String(F(" reason: ")) + String(msg.reason));
+                _scheduleReconnect();
+            } else if (_state == WIRELESS_STATE_CONNECTING || _state == WIRELESS_STATE_ASSOCIATED) {
+                switch (msg.reason) {
+                    case WIFI_REASON_NO_AP_FOUND:
+                        _status = WL_NO_SSID_AVAIL;
+                        break;
+
+                    case WIFI_REASON_AUTH_FAIL:
+                    case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+                        _status = WL_CONNECT_FAILED;
+                        break;
+
+                    default:
+                        _status = WL_DISCONNECTED;
+                        break;
+                }
+
+                if (_fastAttempt) {
+                    Log.warning(F("WIFI"), F("Cached AP not available. Scanning for SSID"));
+                    _stats.fallbacks++;
+                    RtcState.clearWiFi();
+                    _connect(false);
+                } else {
+                    Log.info(F("WIFI"), String(F("Failed to connect to SSID: ")) + _ssid +
+                            String(F(" reason: ")) + String(msg.reason));
+                    Plc.setAlarm(PLC_MOD_WIFI, true);
+                    _scheduleReconnect();
+                }
+            }
             break;
-        }
+    }
+}
+
+void WirelessClass::_scheduleReconnect()
+{
+    _retryDelay = _backoff + (esp_random() % (_backoff / 2 + 1));
+    _backoff = min(_backoff * 2, (unsigned)WIFI_BACKOFF_MAX_MS);
+    _timerRetry = millis();
+    _state = WIRELESS_STATE_BACKOFF;
+}
+
+void WirelessClass::_disconnect()
+{
+    _leaving = true;
+    WiFi.disconnect();
+}
+
+void WirelessClass::_setOnline(bool online)
+{
+    if (_statusLed != nullptr) { Gpio.write(_statusLed, online); }
+    Plc.setAlarm(PLC_MOD_WIFI, !online);
+
+    if (online) {
+        Log.info(F("WIFI"), String(F("PLC was connected to SSID: ")) + _ssid);
+        Log.info(F("WIFI"), String(F("PLC IP address: ")) + getIP());
     }
 }
 
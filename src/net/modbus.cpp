@@ -0,0 +1,273 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "net/modbus.hpp"
+
+static inline uint16_t modbusWord(const uint8_t *buf)
+{
+    return ((uint16_t)buf[0] << 8) | buf[1];
+}
+
+static inline void modbusPut(uint8_t *buf, uint16_t val)
+{
+    buf[0] = val >> 8;
+    buf[1] = val & 0xff;
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+size_t ModbusClass::process(const uint8_t *req, size_t len, uint8_t *resp)
+{
+    ModbusException ex;
+    size_t          out = 0;
+
+    /*
+     * Takes a request PDU and builds the response PDU into resp,
+     * which must hold MODBUS_PDU_MAX bytes.
+     */
+
+    if (len < 1) {
+        return 0;
+    }
+
+    /*
+     * Called from the TCP and RTU tasks, counters are bumped atomically
+     */
+
+    __atomic_add_fetch(&_stats.requests, 1, __ATOMIC_RELAXED);
+
+    switch (req[0]) {
+        case MODBUS_FC_READ_COILS:
+        case MODBUS_FC_READ_INPUTS:
+            ex = _readBits(req, len, resp, out);
+            break;
+
+        case MODBUS_FC_READ_HOLDING:
+        case MODBUS_FC_READ_IREGS:
+            ex = _readRegs(req, len, resp, out);
+            break;
+
+        case MODBUS_FC_WRITE_COIL:
+        case MODBUS_FC_WRITE_REG:
+            ex = _writeSingle(req, len, resp, out);
+            break;
+
+        case MODBUS_FC_WRITE_COILS:
+            ex = _writeCoils(req, len, resp, out);
+            break;
+
+        case MODBUS_FC_WRITE_REGS:
+            ex = _writeRegs(req, len, resp, out);
+            break;
+
+        default:
+            ex = MODBUS_EX_FUNCTION;
+            break;
+    }
+
+    if (ex != MODBUS_EX_NONE) {
+        __atomic_add_fetch(&_stats.exceptions, 1, __ATOMIC_RELAXED);
+        resp[0] = req[0] | 0x80;
+        resp[1] = ex;
+        return 2;
+    }
+
+    return out;
+}
+
+const ModbusStats &ModbusClass::getStats() const
+{
+    return _stats;
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+ModbusException ModbusClass::_readBits(const uint8_t *req, size_t len, uint8_t *resp, size_t &out)
+{
+    RegImageData    img;
+    uint16_t        addr, count;
+    size_t          total;
+    uint64_t        bits;
+
+    if (len != 5) {
+        return MODBUS_EX_VALUE;
+    }
+
+    addr = modbusWord(req + 1);
+    count = modbusWord(req + 3);
+    if (count == 0 || count > MODBUS_READ_BITS_MAX) {
+        return MODBUS_EX_VALUE;
+    }
+
+    total = (req[0] == MODBUS_FC_READ_COILS) ? REGIMAGE_COILS : REGIMAGE_INPUTS;
+    if ((size_t)addr + count > total) {
+        return MODBUS_EX_ADDRESS;
+    }
+
+    RegImage.read(img);
+    bits = (req[0] == MODBUS_FC_READ_COILS) ? img.coils : img.inputs;
+
+    resp[0] = req[0];
+    resp[1] = (count + 7) / 8;
+    memset(resp + 2, 0x0, resp[1]);
+    for (uint16_t i = 0; i < count; i++) {
+        if (bits & (1ULL << (addr + i))) {
+            resp[2 + i / 8] |= (1 << (i % 8));
+        }
+    }
+    out = 2 + resp[1];
+
+    return MODBUS_EX_NONE;
+}
+
+ModbusException ModbusClass::_readRegs(const uint8_t *req, size_t len, uint8_t *resp, size_t &out)
+{
+    RegImageData    img;
+    uint16_t        addr, count;
+    size_t          total;
+    int16_t         val;
+
+    if (len != 5) {
+        return MODBUS_EX_VALUE;
+    }
+
+    addr = modbusWord(req + 1);
+    count = modbusWord(req + 3);
+    if (count == 0 || count > MODBUS_READ_REGS_MAX) {
+        return MODBUS_EX_VALUE;
+    }
+
+    /*
+     * Holding registers mirror the coils as 0/1 words
+     */
+
+    total = (req[0] == MODBUS_FC_READ_HOLDING) ? REGIMAGE_COILS : REGIMAGE_IREGS;
+    if ((size_t)addr + count > total) {
+        return MODBUS_EX_ADDRESS;
+    }
+
+    RegImage.read(img);
+
+    resp[0] = req[0];
+    resp[1] = count * 2;
+    for (uint16_t i = 0; i < count; i++) {
+        if (req[0] == MODBUS_FC_READ_HOLDING) {
+            val = (img.coils & (1UL << (addr + i))) ? 1 : 0;
+        } else {
+            val = img.iregs[addr + i];
+        }
+        modbusPut(resp + 2 + i * 2, (uint16_t)val);
+    }
+    out = 2 + resp[1];
+
+    return MODBUS_EX_NONE;
+}
+
+ModbusException ModbusClass::_writeSingle(const uint8_t *req, size_t len, uint8_t *resp, size_t &out)
+{
+    uint16_t    addr, val;
+
+    if (len != 5) {
+        return MODBUS_EX_VALUE;
+    }
+
+    addr = modbusWord(req + 1);
+    val = modbusWord(req + 3);
+    if (req[0] == MODBUS_FC_WRITE_COIL && val != 0xFF00 && val != 0x0000) {
+        return MODBUS_EX_VALUE;
+    }
+    if (!RegImage.isCoil(addr)) {
+        return MODBUS_EX_ADDRESS;
+    }
+    if (!RegImage.writeCoil(addr, val != 0)) {
+        return MODBUS_EX_FAILURE;
+    }
+    __atomic_add_fetch(&_stats.writes, 1, __ATOMIC_RELAXED);
+
+    memcpy(resp, req, 5);
+    out = 5;
+
+    return MODBUS_EX_NONE;
+}
+
+ModbusException ModbusClass::_writeCoils(const uint8_t *req, size_t len, uint8_t *resp, size_t &out)
+{
+    uint16_t    addr, count;
+
+    if (len < 6) {
+        return MODBUS_EX_VALUE;
+    }
+
+    addr = modbusWord(req + 1);
+    count = modbusWord(req + 3);
+    if (count == 0 || count > MODBUS_WRITE_BITS_MAX || req[5] != (count + 7) / 8 || len != 6 + (size_t)req[5]) {
+        return MODBUS_EX_VALUE;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (!RegImage.isCoil(addr + i)) {
+            return MODBUS_EX_ADDRESS;
+        }
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        if (!RegImage.writeCoil(addr + i, req[6 + i / 8] & (1 << (i % 8)))) {
+            return MODBUS_EX_FAILURE;
+        }
+    }
+    __atomic_add_fetch(&_stats.writes, 1, __ATOMIC_RELAXED);
+
+    memcpy(resp, req, 5);
+    out = 5;
+
+    return MODBUS_EX_NONE;
+}
+
+ModbusException ModbusClass::_writeRegs(const uint8_t *req, size_t len, uint8_t *resp, size_t &out)
+{
+    uint16_t    addr, count;
+
+    if (len < 6) {
+        return MODBUS_EX_VALUE;
+    }
+
+    addr = modbusWord(req + 1);
+    count = modbusWord(req + 3);
+    if (count == 0 || count > MODBUS_WRITE_REGS_MAX || req[5] != count * 2 || len != 6 + (size_t)req[5]) {
+        return MODBUS_EX_VALUE;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (!RegImage.isCoil(addr + i)) {
+            return MODBUS_EX_ADDRESS;
+        }
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        if (!RegImage.writeCoil(addr + i, modbusWord(req + 6 + i * 2) != 0)) {
+            return MODBUS_EX_FAILURE;
+        }
+    }
+    __atomic_add_fetch(&_stats.writes, 1, __ATOMIC_RELAXED);
+
+    memcpy(resp, req, 5);
+    out = 5;
+
+    return MODBUS_EX_NONE;
+}
+
+ModbusClass Modbus;
@@ -0,0 +1,250 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "net/modbusrtu.hpp"
+#include "net/core/gsm.hpp"
+#include "boards/boards.hpp"
+#include "utils/log.hpp"
+
+static const uint16_t crcTable[256] = {
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+};
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+void ModbusRtuClass::setEnabled(bool status)
+{
+    _enabled = status;
+}
+
+bool ModbusRtuClass::getEnabled() const
+{
+    return _enabled;
+}
+
+void ModbusRtuClass::setAddress(uint8_t addr)
+{
+    if (addr < 1 || addr > 247) {
+        Log.error(F("MODBUS"), String(F("Invalid RTU address: ")) + String(addr));
+        return;
+    }
+    _addr = addr;
+}
+
+uint8_t ModbusRtuClass::getAddress() const
+{
+    return _addr;
+}
+
+void ModbusRtuClass::setDePin(int pin)
+{
+    _dePin = pin;
+}
+
+int ModbusRtuClass::getDePin() const
+{
+    return _dePin;
+}
+
+bool ModbusRtuClass::isRunning() const
+{
+    return (_uart != nullptr);
+}
+
+unsigned ModbusRtuClass::getSpeed() const
+{
+    return _speed;
+}
+
+const ModbusRtuStats &ModbusRtuClass::getStats() const
+{
+    return _stats;
+}
+
+void ModbusRtuClass::begin()
+{
+    const ProfUART  &uart = ActiveBoard.interfaces.uart[0];
+    unsigned        symbols;
+
+    if (!_enabled) return;
+
+    /*
+     * Board has a single UART which is shared with the GSM modem
+     */
+
+    if (GsmModem.getEnabled()) {
+        Log.error(F("MODBUS"), F("UART is used by GSM modem, Modbus RTU is not started"));
+        return;
+    }
+
+    _speed = uart.speed;
+
+    /*
+     * Frame gap is 3.5 characters, fixed to 1750 us above 19200 baud
+     */
+
+    if (_speed > MODBUS_RTU_FAST_BAUD) {
+        symbols = ((uint64_t)MODBUS_RTU_FAST_T35_US * _speed + MODBUS_RTU_CHAR_BITS * 1000000UL - 1) /
+                    (MODBUS_RTU_CHAR_BITS * 1000000UL);
+    } else {
+        symbols = 4;
+    }
+    symbols = min(symbols, (unsigned)MODBUS_RTU_TOUT_MAX);
+
+    _uart = new HardwareSerial(uart.id);
+    _uart->setRxBufferSize(MODBUS_RTU_RX_BUF);
+    _uart->begin(_speed, SERIAL_8N1, uart.rx, uart.tx);
+
+    /*
+     * Half-duplex transceivers get DE/RE from the UART RTS line, the
+     * driver raises it for the reply and drops it after the last bit.
+     */
+
+    if (_dePin != MODBUS_RTU_DE_NONE) {
+        if (!_uart->setPins(uart.rx, uart.tx, -1, _dePin) || !_uart->setMode(UART_MODE_RS485_HALF_DUPLEX)) {
+            Log.error(F("MODBUS"), String(F("Failed to set RS-485 direction pin: ")) + String(_dePin));
+        }
+    }
+    _uart->setRxTimeout(symbols);
+    _uart->onReceiveError([this](hardwareSerial_error_t err) {
+        if (err == UART_BUFFER_FULL_ERROR || err == UART_FIFO_OVF_ERROR) {
+            _overrun = true;
+        }
+    });
+    _uart->onReceive([this]() {
+        _onReceive();
+    }, true);
+
+    Log.info(F("MODBUS"), String(F("Modbus RTU slave address: ")) + String(_addr) +
+                            String(F(" speed: ")) + String(_speed) +
+                            String(F(" DE pin: ")) + ((_dePin == MODBUS_RTU_DE_NONE) ? String(F("auto")) : String(_dePin)) +
+                            String(F(" frame gap: ")) + String(symbols) + String(F(" chars")));
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void ModbusRtuClass::_onReceive()
+{
+    int c;
+
+    /*
+     * Called from the UART event task on the RX timeout, the buffer
+     * holds one complete frame.
+     */
+
+    while ((c = _uart->read()) >= 0) {
+        if (_len < MODBUS_RTU_FRAME_MAX) {
+            _frame[_len++] = c;
+        } else {
+            _overrun = true;
+        }
+    }
+
+    if (_overrun) {
+        _stats.overruns++;
+    } else {
+        _process();
+    }
+
+    _len = 0;
+    _overrun = false;
+}
+
+void ModbusRtuClass::_process()
+{
+    uint16_t    crc;
+    size_t      out;
+
+    if (_len < 4) {
+        return;
+    }
+
+    crc = _crc(_frame, _len - 2);
+    if (_frame[_len - 2] != (crc & 0xff) || _frame[_len - 1] != (crc >> 8)) {
+        _stats.crcErrors++;
+        return;
+    }
+
+    if (_frame[0] != _addr && _frame[0] != 0) {
+        _stats.ignored++;
+        return;
+    }
+
+    _stats.frames++;
+
+    out = Modbus.process(_frame + 1, _len - 3, _resp + 1);
+
+    /*
+     * Broadcast requests are executed without a reply
+     */
+
+    if (out == 0 || _frame[0] == 0) {
+        return;
+    }
+
+    _resp[0] = _addr;
+    crc = _crc(_resp, out + 1);
+    _resp[out + 1] = crc & 0xff;
+    _resp[out + 2] = crc >> 8;
+    _uart->write(_resp, out + 3);
+}
+
+uint16_t ModbusRtuClass::_crc(const uint8_t *buf, size_t len) const
+{
+    uint16_t crc = 0xFFFF;
+
+    while (len--) {
+        crc = (crc >> 8) ^ crcTable[(crc ^ *buf++) & 0xff];
+    }
+
+    return crc;
+}
+
+ModbusRtuClass ModbusRtu;
@@ -0,0 +1,171 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "net/modbustcp.hpp"
+#include "utils/log.hpp"
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+void ModbusTcpClass::setEnabled(bool status)
+{
+    _enabled = status;
+}
+
+bool ModbusTcpClass::getEnabled() const
+{
+    return _enabled;
+}
+
+size_t ModbusTcpClass::getClients() const
+{
+    size_t  count = 0;
+
+    for (size_t i = 0; i < MODBUS_TCP_CLIENTS_MAX; i++) {
+        if (_conns[i].client != nullptr) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void ModbusTcpClass::begin()
+{
+    if (!_enabled) return;
+
+    Log.info(F("MODBUS"), String(F("Starting Modbus TCP server at :")) + String(MODBUS_TCP_DEFAULT_PORT));
+
+    /*
+     * All callbacks run in the TCP task, connections are only
+     * touched from there.
+     */
+
+    _server.onClient([this](void *arg, AsyncClient *client) {
+        _onClient(client);
+    }, nullptr);
+    _server.setNoDelay(true);
+    _server.begin();
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void ModbusTcpClass::_onClient(AsyncClient *client)
+{
+    ModbusTcpConn   *conn = nullptr;
+
+    for (size_t i = 0; i < MODBUS_TCP_CLIENTS_MAX; i++) {
+        if (_conns[i].client == nullptr) {
+            conn = &_conns[i];
+            break;
+        }
+    }
+
+    if (conn == nullptr) {
+        Log.warning(F("MODBUS"), String(F("Too many clients, rejected: ")) + client->remoteIP().toString());
+        client->onDisconnect([](void *arg, AsyncClient *c) {
+            delete c;
+        }, nullptr);
+        client->close(true);
+        return;
+    }
+
+    conn->client = client;
+    conn->len = 0;
+
+    client->setRxTimeout(MODBUS_TCP_IDLE_S);
+    client->onData([this, conn](void *arg, AsyncClient *c, void *data, size_t len) {
+        _onData(conn, (const uint8_t *)data, len);
+    }, nullptr);
+    client->onTimeout([](void *arg, AsyncClient *c, uint32_t time) {
+        c->close(true);
+    }, nullptr);
+    client->onDisconnect([this, conn](void *arg, AsyncClient *c) {
+        _onDisconnect(conn);
+        delete c;
+    }, nullptr);
+}
+
+void ModbusTcpClass::_onData(ModbusTcpConn *conn, const uint8_t *data, size_t len)
+{
+    size_t  n;
+
+    while (len > 0) {
+        n = min(len, MODBUS_TCP_FRAME_MAX - conn->len);
+        memcpy(conn->buf + conn->len, data, n);
+        conn->len += n;
+        data += n;
+        len -= n;
+
+        while (_frame(conn)) {}
+
+        if (conn->client == nullptr) {
+            return;
+        }
+        if (conn->len == MODBUS_TCP_FRAME_MAX) {
+            conn->client->close(true);
+            return;
+        }
+    }
+}
+
+void ModbusTcpClass::_onDisconnect(ModbusTcpConn *conn)
+{
+    conn->client = nullptr;
+    conn->len = 0;
+}
+
+bool ModbusTcpClass::_frame(ModbusTcpConn *conn)
+{
+    uint16_t    length;
+    size_t      total, out;
+
+    if (conn->len < MODBUS_TCP_MBAP_LEN) {
+        return false;
+    }
+
+    /*
+     * MBAP: transaction id, protocol id (0), length of unit id + PDU
+     */
+
+    length = ((uint16_t)conn->buf[4] << 8) | conn->buf[5];
+    if (conn->buf[2] != 0 || conn->buf[3] != 0 || length < 2 || length > MODBUS_PDU_MAX + 1) {
+        conn->len = 0;
+        conn->client->close(true);
+        return false;
+    }
+
+    total = 6 + length;
+    if (conn->len < total) {
+        return false;
+    }
+
+    out = Modbus.process(conn->buf + MODBUS_TCP_MBAP_LEN, length - 1, _resp + MODBUS_TCP_MBAP_LEN);
+    if (out > 0) {
+        memcpy(_resp, conn->buf, MODBUS_TCP_MBAP_LEN);
+        _resp[4] = (out + 1) >> 8;
+        _resp[5] = (out + 1) & 0xff;
+        conn->client->write((const char *)_resp, MODBUS_TCP_MBAP_LEN + out);
+    }
+
+    conn->len -= total;
+    memmove(conn->buf, conn->buf + total, conn->len);
+
+    return true;
+}
+
+ModbusTcpClass ModbusTcp(MODBUS_TCP_DEFAULT_PORT);
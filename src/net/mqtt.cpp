@@ -0,0 +1,385 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "net/mqtt.hpp"
+#include "net/core/wifi.hpp"
+#include "net/apiwriter.hpp"
+#include "core/plc.hpp"
+#include "core/regimage.hpp"
+#include "controllers/socket/socket.hpp"
+#include "utils/log.hpp"
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+void MqttClass::setEnabled(bool status)
+{
+    _enabled = status;
+}
+
+bool MqttClass::getEnabled() const
+{
+    return _enabled;
+}
+
+void MqttClass::setServer(const String &host, uint16_t port)
+{
+    _host = host;
+    _port = port;
+}
+
+const String &MqttClass::getHost() const
+{
+    return _host;
+}
+
+uint16_t MqttClass::getPort() const
+{
+    return _port;
+}
+
+void MqttClass::setCreds(const String &user, const String &passwd)
+{
+    _user = user;
+    _passwd = passwd;
+}
+
+const String &MqttClass::getUser() const
+{
+    return _user;
+}
+
+const String &MqttClass::getPasswd() const
+{
+    return _passwd;
+}
+
+void MqttClass::setPrefix(const String &prefix)
+{
+    _prefix = prefix;
+}
+
+const String &MqttClass::getPrefix() const
+{
+    return _prefix;
+}
+
+void MqttClass::setPeriod(unsigned period)
+{
+    _period = period;
+}
+
+unsigned MqttClass::getPeriod() const
+{
+    return _period;
+}
+
+bool MqttClass::isConnected() const
+{
+    return _connected;
+}
+
+size_t MqttClass::getQueueSize()
+{
+    size_t  count;
+
+    if (_lock == nullptr) {
+        return 0;
+    }
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    count = _count;
+    xSemaphoreGive(_lock);
+
+    return count;
+}
+
+const MqttStats &MqttClass::getStats() const
+{
+    return _stats;
+}
+
+void MqttClass::begin()
+{
+    if (!_enabled || _host == "") return;
+
+    Log.info(F("MQTT"), String(F("Starting MQTT client to ")) + _host + ":" + String(_port));
+
+    _lock = xSemaphoreCreateMutex();
+    _client.setServer(_host.c_str(), _port);
+    _client.setBufferSize(MQTT_BUFFER_SIZE);
+    _client.setKeepAlive(MQTT_KEEPALIVE_S);
+    _client.setCallback([this](char *topic, uint8_t *payload, unsigned len) {
+        _onMessage(topic, payload, len);
+    });
+
+    _version = Plc.getVersion();
+    _alarm = Plc.getAlarm();
+
+    if (xTaskCreate(_taskHandler, "mqtt", MQTT_TASK_STACK, this, MQTT_TASK_PRIO, &_task) != pdPASS) {
+        Log.error(F("MQTT"), F("Failed to start MQTT task"));
+        _task = nullptr;
+    }
+}
+
+void MqttClass::loop()
+{
+    if (_lock == nullptr) return;
+
+    /*
+     * Full state after every (re)connect so retained topics are
+     * correct even if the broker lost them.
+     */
+
+    if (_resync) {
+        _resync = false;
+        _publishState(true);
+    } else if (Plc.getVersion() != _version) {
+        _publishState(false);
+    }
+
+    if (millis() - _timerTelemetry >= _period) {
+        _timerTelemetry = millis();
+        _publishTelemetry();
+    }
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void MqttClass::_taskHandler(void *arg)
+{
+    MqttClass   *mqtt = static_cast<MqttClass *>(arg);
+
+    for (;;) {
+        if (Wireless.getStatus() != WL_CONNECTED) {
+            mqtt->_connected = false;
+            vTaskDelay(pdMS_TO_TICKS(MQTT_WIFI_WAIT_MS));
+            continue;
+        }
+
+        if (!mqtt->_client.connected()) {
+            mqtt->_connected = false;
+            if (millis() - mqtt->_timerRetry < mqtt->_retryDelay || !mqtt->_connect()) {
+                vTaskDelay(pdMS_TO_TICKS(MQTT_WIFI_WAIT_MS));
+                continue;
+            }
+        }
+
+        mqtt->_client.loop();
+        mqtt->_drain();
+
+        vTaskDelay(pdMS_TO_TICKS(MQTT_TASK_DELAY_MS));
+    }
+}
+
+bool MqttClass::_connect()
+{
+    String  id = _prefix + "-" + String((uint32_t)ESP.getEfuseMac(), HEX);
+    String  will = _prefix + F("/status");
+    String  sub = _prefix + F("/socket/+/set");
+
+    _timerRetry = millis();
+
+    if (!_client.connect(id.c_str(), (_user != "") ? _user.c_str() : nullptr,
+                        (_passwd != "") ? _passwd.c_str() : nullptr,
+                        will.c_str(), 1, true, "offline")) {
+        Log.error(F("MQTT"), String(F("Failed to connect to broker, state: ")) + String(_client.state()));
+        _retryDelay = min(_retryDelay * 2, (unsigned)MQTT_RETRY_MAX_MS);
+        return false;
+    }
+
+    _client.publish(will.c_str(), "online", true);
+    _client.subscribe(sub.c_str());
+
+    _retryDelay = MQTT_RETRY_MIN_MS;
+    _stats.connects++;
+    _connected = true;
+    _resync = true;
+
+    Log.info(F("MQTT"), F("Connected to broker"));
+
+    return true;
+}
+
+void MqttClass::_drain()
+{
+    MqttMsg msg;
+
+    /*
+     * Oldest message is removed only after it was handed to the
+     * broker, so it survives a dropped connection.
+     */
+
+    for (;;) {
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        if (_count == 0) {
+            xSemaphoreGive(_lock);
+            return;
+        }
+        memcpy(&msg, &_queue[_head], sizeof(MqttMsg));
+        xSemaphoreGive(_lock);
+
+        if (!_client.publish(msg.topic, msg.payload, msg.retain)) {
+            _stats.failed++;
+            return;
+        }
+        _stats.published++;
+        _stats.bytes += strlen(msg.topic) + strlen(msg.payload);
+
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        if (_count > 0 && _queue[_head].seq == msg.seq) {
+            _head = (_head + 1) % MQTT_QUEUE_SIZE;
+            _count--;
+        }
+        xSemaphoreGive(_lock);
+    }
+}
+
+void MqttClass::_onMessage(char *topic, uint8_t *payload, unsigned len)
+{
+    char    value[8];
+    Socket  *socket;
+    size_t  plen = _prefix.length();
+    int     id;
+    bool    status;
+
+    /*
+     * <prefix>/socket/<id>/set with ON, OFF or TOGGLE, applied by
+     * the main loop through the register image.
+     */
+
+    if (strncmp(topic, _prefix.c_str(), plen) != 0 || sscanf(topic + plen, "/socket/%d/set", &id) != 1) {
+        return;
+    }
+    if (id < 1 || !SocketCtrl.getSocket((size_t)(id - 1), &socket)) {
+        return;
+    }
+
+    len = min(len, (unsigned)sizeof(value) - 1);
+    memcpy(value, payload, len);
+    value[len] = '\0';
+
+    if (!strcasecmp(value, "on") || !strcmp(value, "1") || !strcasecmp(value, "true")) {
+        status = true;
+    } else if (!strcasecmp(value, "off") || !strcmp(value, "0") || !strcasecmp(value, "false")) {
+        status = false;
+    } else if (!strcasecmp(value, "toggle")) {
+        status = !socket->status;
+    } else {
+        Log.warning(F("MQTT"), String(F("Unknown socket command: ")) + value);
+        return;
+    }
+
+    if (RegImage.writeCoil(id - 1, status)) {
+        _stats.commands++;
+    }
+}
+
+void MqttClass::_push(const char *suffix, const char *payload, bool retain)
+{
+    xSemaphoreTake(_lock, portMAX_DELAY);
+
+    /*
+     * Full ring drops the oldest message, state is resent on resync
+     */
+
+    if (_count == MQTT_QUEUE_SIZE) {
+        _head = (_head + 1) % MQTT_QUEUE_SIZE;
+        _count--;
+        _stats.dropped++;
+    }
+
+    MqttMsg &msg = _queue[(_head + _count) % MQTT_QUEUE_SIZE];
+
+    msg.seq = ++_seq;
+    msg.retain = retain;
+    snprintf(msg.topic, MQTT_TOPIC_LEN, "%s/%s", _prefix.c_str(), suffix);
+    strncpy(msg.payload, payload, MQTT_PAYLOAD_LEN - 1);
+    msg.payload[MQTT_PAYLOAD_LEN - 1] = '\0';
+    _count++;
+    if (_count > _stats.maxQueue) {
+        _stats.maxQueue = _count;
+    }
+
+    xSemaphoreGive(_lock);
+}
+
+void MqttClass::_publishState(bool full)
+{
+    char        suffix[MQTT_TOPIC_LEN];
+    char        value[12];
+    Socket      *socket;
+    uint32_t    version = Plc.getVersion();
+
+    for (size_t i = 0; SocketCtrl.getSocket(i, &socket); i++) {
+        if (!socket->enabled || (!full && socket->version <= _version)) {
+            continue;
+        }
+        snprintf(suffix, sizeof(suffix), "socket/%u/state", (unsigned)socket->id);
+        _push(suffix, socket->status ? "ON" : "OFF", true);
+    }
+
+    if (full || Plc.getAlarm() != _alarm) {
+        _alarm = Plc.getAlarm();
+        snprintf(value, sizeof(value), "%u", _alarm);
+        _push("alarm", value, true);
+    }
+
+    _version = version;
+}
+
+void MqttClass::_publishTelemetry()
+{
+    char        payload[MQTT_PAYLOAD_LEN];
+    ApiWriter   writer(payload, sizeof(payload));
+    MeteoSensor *sensor;
+
+    /*
+     * Sensor values go out as one message per period
+     */
+
+    writer.beginObject();
+    writer.add("temp", Plc.getBoardTemp(), 1);
+    writer.add("fan", Plc.getFanStatus());
+    writer.add("alarm", (long)Plc.getAlarm());
+    writer.add("rssi", (long)WiFi.RSSI());
+    writer.add("heap", (long)ESP.getFreeHeap());
+    writer.add("uptime", (long)(millis() / 1000));
+
+    /*
+     * Meteo sensors by name, the ones that don't fit the payload
+     * are left out instead of breaking the message.
+     */
+
+    writer.beginObject("sensors");
+    for (size_t i = 0; i < RegImage.getSensorCount(); i++) {
+        if (sizeof(payload) - writer.length() < MQTT_SENSOR_ITEM_MAX + 4) {
+            break;
+        }
+        sensor = RegImage.getSensor(i);
+        writer.add(sensor->getName().c_str(), sensor->getTemperature(), 1, MQTT_SENSOR_NAME_MAX);
+    }
+    writer.endObject();
+    writer.endObject();
+
+    if (!writer.overflow()) {
+        _push("telemetry", writer.c_str(), false);
+    }
+}
+
+MqttClass Mqtt;
@@ -0,0 +1,367 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "net/replica.hpp"
+#include "net/core/wifi.hpp"
+#include "utils/log.hpp"
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+void ReplicaClass::setEnabled(bool status)
+{
+    _enabled = status;
+}
+
+bool ReplicaClass::getEnabled() const
+{
+    return _enabled;
+}
+
+void ReplicaClass::setNode(uint8_t node)
+{
+    _node = node;
+}
+
+uint8_t ReplicaClass::getNode() const
+{
+    return _node;
+}
+
+void ReplicaClass::setGroup(const IPAddress &ip, uint16_t port)
+{
+    _group = ip;
+    _port = port;
+}
+
+const IPAddress &ReplicaClass::getGroup() const
+{
+    return _group;
+}
+
+uint16_t ReplicaClass::getPort() const
+{
+    return _port;
+}
+
+void ReplicaClass::clearMap()
+{
+    _mapCount = 0;
+}
+
+bool ReplicaClass::addMap(uint16_t pin, uint8_t node, ReplicaSource source, uint8_t index)
+{
+    ReplicaMap *map;
+
+    if (_mapCount == REPLICA_MAP_MAX || node == 0) {
+        return false;
+    }
+    if ((source == REPLICA_SRC_INPUT && index >= REGIMAGE_INPUTS) ||
+        (source == REPLICA_SRC_SOCKET && index >= REGIMAGE_COILS)) {
+        return false;
+    }
+
+    map = &_map[_mapCount];
+    if (!Gpio.addVirtual(pin, &map->pin)) {
+        return false;
+    }
+
+    map->node = node;
+    map->source = source;
+    map->index = index;
+    _mapCount++;
+    return true;
+}
+
+size_t ReplicaClass::getMapCount() const
+{
+    return _mapCount;
+}
+
+const ReplicaMap &ReplicaClass::getMap(size_t index) const
+{
+    return _map[index];
+}
+
+size_t ReplicaClass::getPeers(ReplicaPeer *peers, size_t size)
+{
+    size_t count = 0;
+
+    if (_lock == nullptr) return 0;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (size_t i = 0; i < REPLICA_PEERS_MAX && count < size; i++) {
+        if (_peers[i].node != 0) {
+            peers[count++] = _peers[i];
+        }
+    }
+    xSemaphoreGive(_lock);
+    return count;
+}
+
+uint32_t ReplicaClass::getVersion() const
+{
+    return _state.version;
+}
+
+const ReplicaStats &ReplicaClass::getStats() const
+{
+    return _stats;
+}
+
+void ReplicaClass::begin()
+{
+    if (!_enabled) return;
+
+    if (_node == 0 || _group[0] < 224 || _group[0] > 239) {
+        Log.error(F("REPL"), String(F("Invalid node or multicast group: ")) + _group.toString());
+        return;
+    }
+
+    _lock = xSemaphoreCreateMutex();
+
+    /*
+     * Boot id lets peers tell a restarted node from a late message
+     * and drop the versions they have seen from it.
+     */
+
+    _state.magic = REPLICA_MAGIC;
+    _state.proto = REPLICA_PROTO;
+    _state.node = _node;
+    _state.boot = esp_random();
+    _update();
+    _apply();
+
+    _timerSync = millis() - REPLICA_SYNC_MS;
+    _running = true;
+
+    Log.info(F("REPL"), String(F("Node ")) + String(_node) + String(F(" replicating on ")) +
+                        _group.toString() + ":" + String(_port) + String(F(", mapped pins: ")) +
+                        String(_mapCount));
+}
+
+void ReplicaClass::loop()
+{
+    if (!_running) return;
+
+    if (Wireless.getStatus() != WL_CONNECTED) {
+        if (_listening) {
+            _udp.close();
+            _listening = false;
+        }
+    } else if (!_listening && (millis() - _timerSync) >= REPLICA_SYNC_MS) {
+        _timerSync = millis();
+        _listen();
+    }
+
+    if (_listening) {
+        if (_update()) {
+            /*
+             * Deltas go out at once and once more shortly after, a
+             * single lost datagram then costs nothing on Wi-Fi.
+             */
+
+            _send(REPLICA_MSG_STATE);
+            _repeat = true;
+            _resync = false;
+            _timerRepeat = _timerSync = millis();
+        } else if (_repeat && (millis() - _timerRepeat) >= REPLICA_REPEAT_MS) {
+            _send(REPLICA_MSG_STATE);
+            _repeat = false;
+        } else if (_resync || (millis() - _timerSync) >= REPLICA_SYNC_MS) {
+            _send(REPLICA_MSG_STATE);
+            _resync = false;
+            _timerSync = millis();
+        }
+    }
+
+    if (_expire() || _dirty) {
+        _dirty = false;
+        _apply();
+    }
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void ReplicaClass::_listen()
+{
+    if (!_udp.listenMulticast(_group, _port)) {
+        Log.error(F("REPL"), String(F("Failed to join group ")) + _group.toString());
+        return;
+    }
+
+    _udp.onPacket([this](AsyncUDPPacket &packet) {
+        _onPacket(packet);
+    });
+    _listening = true;
+
+    /*
+     * Join carries our state and asks every peer for theirs, so the
+     * remote table is complete without waiting for the periodic sync.
+     */
+
+    _send(REPLICA_MSG_JOIN);
+    _timerSync = millis();
+}
+
+bool ReplicaClass::_update()
+{
+    RegImageData data;
+
+    RegImage.read(data);
+    if (data.coils == _state.coils && data.sockets == _state.sockets && data.inputs == _state.inputs) {
+        return false;
+    }
+
+    _state.coils = data.coils;
+    _state.sockets = data.sockets;
+    _state.inputs = data.inputs;
+    _state.version++;
+    return true;
+}
+
+void ReplicaClass::_send(ReplicaMsgType type)
+{
+    _state.type = type;
+    if (_udp.writeTo((const uint8_t *)&_state, sizeof(ReplicaMsg), _group, _port) == sizeof(ReplicaMsg)) {
+        _stats.sent++;
+    }
+}
+
+void ReplicaClass::_onPacket(AsyncUDPPacket &packet)
+{
+    ReplicaMsg  msg;
+    ReplicaPeer *peer = nullptr;
+
+    if (packet.length() != sizeof(ReplicaMsg)) {
+        _stats.invalid++;
+        return;
+    }
+
+    memcpy(&msg, packet.data(), sizeof(ReplicaMsg));
+    if (msg.magic != REPLICA_MAGIC || msg.proto != REPLICA_PROTO || msg.node == 0) {
+        _stats.invalid++;
+        return;
+    }
+
+    if (msg.node == _node) {
+        if (msg.boot != _state.boot) {
+            _stats.conflicts++;
+        }
+        return;
+    }
+
+    _stats.received++;
+    if (msg.type == REPLICA_MSG_JOIN) {
+        _stats.joins++;
+        _resync = true;
+    }
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (size_t i = 0; i < REPLICA_PEERS_MAX; i++) {
+        if (_peers[i].node == msg.node) {
+            peer = &_peers[i];
+            break;
+        }
+        if (_peers[i].node == 0 && peer == nullptr) {
+            peer = &_peers[i];
+        }
+    }
+
+    if (peer == nullptr) {
+        xSemaphoreGive(_lock);
+        _stats.overflows++;
+        return;
+    }
+
+    if (peer->node != msg.node || peer->boot != msg.boot || !peer->online ||
+        (int32_t)(msg.version - peer->version) > 0) {
+        peer->node = msg.node;
+        peer->boot = msg.boot;
+        peer->version = msg.version;
+        peer->coils = msg.coils;
+        peer->sockets = msg.sockets;
+        peer->inputs = msg.inputs;
+        peer->ip = packet.remoteIP();
+        peer->online = true;
+        _stats.applied++;
+        _dirty = true;
+    } else if (msg.version != peer->version) {
+        _stats.stale++;
+    }
+    peer->seen = millis();
+    xSemaphoreGive(_lock);
+}
+
+bool ReplicaClass::_expire()
+{
+    uint8_t nodes[REPLICA_PEERS_MAX];
+    size_t  count = 0;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (size_t i = 0; i < REPLICA_PEERS_MAX; i++) {
+        if (_peers[i].online && (millis() - _peers[i].seen) >= REPLICA_PEER_TIMEOUT_MS) {
+            _peers[i].online = false;
+            nodes[count++] = _peers[i].node;
+        }
+    }
+    xSemaphoreGive(_lock);
+
+    for (size_t i = 0; i < count; i++) {
+        Log.warning(F("REPL"), String(F("Node ")) + String(nodes[i]) + String(F(" is offline")));
+    }
+    return (count > 0);
+}
+
+void ReplicaClass::_apply()
+{
+    bool levels[REPLICA_MAP_MAX];
+
+    /*
+     * Mirrored inputs keep the active low level of a button, offline
+     * peers release their pins and drop their sockets to off.
+     */
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (size_t i = 0; i < _mapCount; i++) {
+        const ReplicaMap    &map = _map[i];
+        const ReplicaPeer   *peer = nullptr;
+
+        for (size_t k = 0; k < REPLICA_PEERS_MAX; k++) {
+            if (_peers[k].node == map.node && _peers[k].online) {
+                peer = &_peers[k];
+                break;
+            }
+        }
+
+        if (map.source == REPLICA_SRC_INPUT) {
+            levels[i] = (peer == nullptr || !(peer->inputs & (1ULL << map.index)));
+        } else {
+            levels[i] = (peer != nullptr && (peer->coils & (1UL << map.index)));
+        }
+    }
+    xSemaphoreGive(_lock);
+
+    for (size_t i = 0; i < _mapCount; i++) {
+        if (_map[i].pin->state != levels[i]) {
+            Gpio.write(_map[i].pin, levels[i]);
+        }
+    }
+}
+
+ReplicaClass Replica;
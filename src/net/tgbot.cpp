@@ -13,6 +13,7 @@
 #include "net/core/wifi.hpp"
 #include "controllers/ctrls.hpp"
 #include "controllers/socket/socket.hpp"
+#include "core/plc.hpp"
 
 /*********************************************************************/
 /*                                                                   */
@@ -52,17 +53,36 @@ bool TgBotClass::getUser(size_t index, TgUser **user)
     return false;
 }
 
-bool TgBotClass::getUserByChatId(unsigned chatId, TgUser **user)
+bool TgBotClass::getUserByChatId(int64_t chatId, TgUser **user)
 {
-    for (size_t i = 0; i < _users.size(); i++) {
-        if (_users[i].chatId == chatId) {
-            *user = &_users[i];
+    size_t  slot = _hashChatId(chatId);
+
+    /*
+     * Index holds enabled users only, so a hit is also the access check
+     */
+
+    for (size_t i = 0; i < TG_USERS_HASH_SIZE; i++) {
+        int16_t idx = _usersIndex[slot];
+
+        if (idx == TG_USERS_HASH_NONE) {
+            return false;
+        }
+        if (_users[idx].chatId == chatId) {
+            *user = &_users[idx];
             return true;
         }
+        slot = (slot + 1) & (TG_USERS_HASH_SIZE - 1);
     }
     return false;
 }
 
+void TgBotClass::updateUsers()
+{
+    lock();
+    _buildIndex();
+    unlock();
+}
+
 bool TgBotClass::isUserExists(const String &name) const
 {
     for (auto u : _users) {
@@ -78,7 +98,10 @@ bool TgBotClass::setUser(size_t index, TgUser *user)
     if (index >= _users.size())
         return false;
 
-    memcpy(&_users[index], user, sizeof(TgUser));
+    lock();
+    _users[index] = *user;
+    _buildIndex();
+    unlock();
 
     return true;
 }
@@ -97,6 +120,45 @@ std::array<TgUser, TG_USERS_COUNT> *TgBotClass::getUsers()
     return &_users;
 }
 
+void TgBotClass::setToken(const String &token)
+{
+    lock();
+    FastBot2Client::setToken(token);
+    unlock();
+}
+
+void TgBotClass::setPollMode(fb::Poll mode, uint16_t period)
+{
+    lock();
+    FastBot2Client::setPollMode(mode, period);
+    unlock();
+}
+
+void TgBotClass::setProxy(const char *host, uint16_t port)
+{
+    lock();
+    FastBot2Client::setProxy(host, port);
+    unlock();
+}
+
+void TgBotClass::lock()
+{
+    /*
+     * Lock exists once begin() ran, before that there is no bot task
+     */
+
+    if (_botLock != nullptr) {
+        xSemaphoreTakeRecursive(_botLock, portMAX_DELAY);
+    }
+}
+
+void TgBotClass::unlock()
+{
+    if (_botLock != nullptr) {
+        xSemaphoreGiveRecursive(_botLock);
+    }
+}
+
 void TgBotClass::begin()
 {
     if (!_enabled || getToken() == "") return;
@@ -107,19 +169,80 @@ void TgBotClass::begin()
 
     Log.info(F("TG"), "Starting Telegram Bot");
 
+    if (_task == nullptr) {
+        _ctrlQueue = xQueueCreate(TG_CTRL_QUEUE_LEN, sizeof(TgCtrlMsg));
+        _notifyQueue = xQueueCreate(TG_NOTIFY_QUEUE_LEN, sizeof(TgNotifyMsg));
+        _botLock = xSemaphoreCreateRecursiveMutex();
+        _sockLock = xSemaphoreCreateMutex();
+    }
+
+    xSemaphoreTakeRecursive(_botLock, portMAX_DELAY);
     attachUpdate([this](fb::Update& u){ _updateHandler(u); });
+    _client.close();
     skipUpdates();
-    FastBot2::begin();
+    FastBot2Client::begin();
+    xSemaphoreGiveRecursive(_botLock);
+
+    _updateSockets();
+
+    /*
+     * HTTP round trips to Telegram run in the bot task, controls come
+     * back through _ctrlQueue and are applied by loop().
+     */
+
+    if (_task == nullptr) {
+        if (xTaskCreate(_taskHandler, "tgbot", TG_TASK_STACK, this, TG_TASK_PRIO, &_task) != pdPASS) {
+            Log.error(F("TG"), F("Failed to start bot task"));
+            _task = nullptr;
+        }
+    }
 }
 
 void TgBotClass::loop()
 {
-    if (!_enabled || getToken() == "") return;
-    if (Wireless.getEnabled() && Wireless.getStatus() != WL_CONNECTED) return;
-    tick();
+    TgCtrlMsg   msg;
+
+    if (_ctrlQueue == nullptr) return;
+
+    while (xQueueReceive(_ctrlQueue, &msg, 0) == pdTRUE) {
+        _applyControl(msg);
+    }
+
+    _updateSockets();
+}
+
+bool TgBotClass::notify(TgNotifyType type, const String &text, bool status)
+{
+    TgNotifyMsg msg;
+
+    if (!_enabled || _notifyQueue == nullptr) {
+        return false;
+    }
+
+    msg.type = type;
+    msg.status = status;
+    strncpy(msg.text, text.c_str(), TG_NOTIFY_TEXT_LEN - 1);
+    msg.text[TG_NOTIFY_TEXT_LEN - 1] = '\0';
+
+    if (xQueueSend(_notifyQueue, &msg, 0) != pdTRUE) {
+        _notifyStats.dropped++;
+        return false;
+    }
+
+    return true;
 }
 
-unsigned TgBotClass::getLastID() const
+const TgNotifyStats &TgBotClass::getNotifyStats() const
+{
+    return _notifyStats;
+}
+
+const TgClientStats &TgBotClass::getClientStats() const
+{
+    return _client.getStats();
+}
+
+int64_t TgBotClass::getLastID() const
 {
     return _lastID;
 }
@@ -130,6 +253,346 @@ unsigned TgBotClass::getLastID() const
 /*                                                                   */
 /*********************************************************************/
 
+void TgBotClass::_taskHandler(void *arg)
+{
+    TgBotClass  *bot = static_cast<TgBotClass *>(arg);
+
+    for (;;) {
+        bool online = bot->_enabled && bot->getToken() != "" &&
+                        (!Wireless.getEnabled() || Wireless.getStatus() == WL_CONNECTED);
+
+        /*
+         * Notifications are still coalesced offline so the queue
+         * keeps draining and memory stays bounded.
+         */
+
+        bot->_notifyLoop(online);
+
+        if (!online) {
+            vTaskDelay(pdMS_TO_TICKS(TG_WIFI_WAIT_MS));
+            continue;
+        }
+
+        xSemaphoreTakeRecursive(bot->_botLock, portMAX_DELAY);
+        bot->tick();
+        xSemaphoreGiveRecursive(bot->_botLock);
+
+        vTaskDelay(pdMS_TO_TICKS(TG_TASK_DELAY_MS));
+    }
+}
+
+bool TgBotClass::_control(const TgCtrlMsg &msg)
+{
+    if (xQueueSend(_ctrlQueue, &msg, 0) != pdTRUE) {
+        Log.warning(F("TG"), F("Control queue is full"));
+        return false;
+    }
+    return true;
+}
+
+void TgBotClass::_applyControl(const TgCtrlMsg &msg)
+{
+    Socket  *socket;
+
+    switch (msg.type) {
+        case TG_CTRL_SOCKET:
+            if (SocketCtrl.getSocket(msg.id - 1, &socket) && socket->enabled) {
+                SocketCtrl.setStatus(socket, msg.status, true);
+            }
+            break;
+    }
+}
+
+void TgBotClass::_updateSockets()
+{
+    uint32_t    mask = 0;
+    size_t      count = 0;
+
+    for (auto &socket : *SocketCtrl.getSockets()) {
+        if (!socket.enabled) continue;
+        if (socket.status) {
+            mask |= (1UL << count);
+        }
+        count++;
+    }
+
+    if (mask == _sockMask && count == _sockCount && !_menusDirty) return;
+
+    xSemaphoreTake(_sockLock, portMAX_DELAY);
+    if (count != _sockCount || _menusDirty) {
+        _sockVersion++;
+        _menusDirty = false;
+    }
+    _sockStates.clear();
+    for (auto &socket : *SocketCtrl.getSockets()) {
+        if (!socket.enabled) continue;
+        _sockStates.push_back({ .id = socket.id, .name = socket.name, .status = socket.status });
+    }
+    _sockMask = mask;
+    _sockCount = count;
+    xSemaphoreGive(_sockLock);
+}
+
+void TgBotClass::_getSockets(std::vector<TgSocketState> &socks, unsigned &version)
+{
+    xSemaphoreTake(_sockLock, portMAX_DELAY);
+    socks = _sockStates;
+    version = _sockVersion;
+    xSemaphoreGive(_sockLock);
+}
+
+void TgBotClass::invalidateMenus()
+{
+    _menusDirty = true;
+}
+
+fb::Menu &TgBotClass::_getMenu(TgMenuLevel level)
+{
+    fb::Menu    &menu = _menus[level];
+
+    if (_menuValid[level]) {
+        return menu;
+    }
+
+    menu = fb::Menu();
+
+    switch (level) {
+        case TG_MENU_MAIN:
+            menu.addButton(F("Я дома"));
+            menu.addButton(F("Ушёл"));
+            menu.newRow();
+            menu.addButton(F("Розетки"));
+            menu.newRow();
+            break;
+
+        default:
+            menu.addButton(F("Обновить"));
+            menu.addButton(F("Назад"));
+            break;
+    }
+
+    _menuValid[level] = true;
+    return menu;
+}
+
+fb::InlineMenu &TgBotClass::_getSocketsMenu(const std::vector<TgSocketState> &socks, unsigned version)
+{
+    if (_sockMenuValid && version == _menuSockVersion) {
+        return _sockMenu;
+    }
+
+    _sockMenu = fb::InlineMenu();
+    for (auto &socket : socks) {
+        _sockMenu.addButton(socket.name, String(F("s:")) + String(socket.id) + F(":t"));
+        _sockMenu.newRow();
+    }
+    _sockMenu.addButton(F("Вкл.все"), F("s:0:1"));
+    _sockMenu.addButton(F("Откл.все"), F("s:0:0"));
+    _sockMenu.newRow();
+    _sockMenu.addButton(F("Обновить"), F("s:0:r"));
+
+    _menuSockVersion = version;
+    _sockMenuValid = true;
+
+    return _sockMenu;
+}
+
+String TgBotClass::_socketsText(const std::vector<TgSocketState> &socks)
+{
+    String text = F("<b>РОЗЕТКИ:</b>\n\n");
+
+    for (auto &socket : socks) {
+        text += "<b>" + socket.name + ":</b> " + (socket.status ? F("Включен") : F("Отключен")) + "\n";
+    }
+
+    return text;
+}
+
+void TgBotClass::_notifyLoop(bool online)
+{
+    TgNotifyMsg msg;
+
+    while (xQueueReceive(_notifyQueue, &msg, 0) == pdTRUE) {
+        bool merged = false;
+
+        /*
+         * Same item in one window keeps only the latest status
+         */
+
+        for (auto &event : _notifyBatch) {
+            if (event.type == msg.type && strcmp(event.text, msg.text) == 0) {
+                event.status = msg.status;
+                merged = true;
+                break;
+            }
+        }
+        if (merged) continue;
+
+        if (_notifyBatch.size() >= TG_NOTIFY_BATCH_MAX) {
+            _notifyOverflow++;
+            continue;
+        }
+
+        if (_notifyBatch.empty() && _notifyOverflow == 0) {
+            _timerNotify = millis();
+        }
+        _notifyBatch.push_back(msg);
+        _notifyStats.queued++;
+    }
+
+    if ((!_notifyBatch.empty() || _notifyOverflow > 0) && millis() - _timerNotify >= TG_NOTIFY_WINDOW_MS) {
+        _notifyFlush();
+    }
+
+    if (online) {
+        _notifySend();
+    }
+}
+
+void TgBotClass::_notifyFlush()
+{
+    String      text;
+    String      on;
+    String      off;
+    unsigned    onCount = 0;
+    unsigned    offCount = 0;
+
+    for (auto &event : _notifyBatch) {
+        switch (event.type) {
+            case TG_NOTIFY_SOCKET:
+                if (event.status) {
+                    on += String(F("<b>")) + event.text + String(F(":</b> Включен\n"));
+                    onCount++;
+                } else {
+                    off += String(F("<b>")) + event.text + String(F(":</b> Отключен\n"));
+                    offCount++;
+                }
+                break;
+
+            case TG_NOTIFY_ALARM:
+            case TG_NOTIFY_TEXT:
+                text += String(event.text) + "\n";
+                break;
+        }
+    }
+
+    if (onCount > TG_NOTIFY_LIST_MAX) {
+        text += String(F("Включено розеток: ")) + String(onCount) + "\n";
+    } else {
+        text += on;
+    }
+    if (offCount > TG_NOTIFY_LIST_MAX) {
+        text += String(F("Отключено розеток: ")) + String(offCount) + "\n";
+    } else {
+        text += off;
+    }
+    if (_notifyOverflow > 0) {
+        text += String(F("И ещё событий: ")) + String(_notifyOverflow) + "\n";
+        _notifyStats.dropped += _notifyOverflow;
+    }
+
+    _notifyBatch.clear();
+    _notifyOverflow = 0;
+
+    lock();
+    for (size_t i = 0; i < _users.size(); i++) {
+        TgOutbox &box = _outbox[i];
+
+        if (!_users[i].enabled || !_users[i].notify) continue;
+
+        /*
+         * Unsent text is extended, the oldest part is dropped when
+         * the network has been down for too long.
+         */
+
+        if (box.text == "") {
+            box.next = millis();
+            box.tries = 0;
+        }
+        if (box.text.length() + text.length() > TG_NOTIFY_MSG_MAX) {
+            box.text = "";
+            _notifyStats.dropped++;
+        }
+        box.text += text;
+    }
+    unlock();
+}
+
+void TgBotClass::_notifySend()
+{
+    if (millis() - _timerSend < TG_NOTIFY_GLOBAL_MS) return;
+
+    lock();
+    for (size_t i = 0; i < _users.size(); i++) {
+        TgOutbox    &box = _outbox[i];
+        fb::Message msg;
+
+        if (box.text == "" || (int)(millis() - box.next) < 0) continue;
+
+        msg.chatID = _users[i].chatId;
+        msg.mode = fb::Message::Mode::HTML;
+        msg.text = String(F("<b>")) + Plc.getName() + String(F("</b>\n\n")) + box.text;
+
+        auto res = sendMessage(msg);
+
+        _timerSend = millis();
+
+        if (res.valid()) {
+            box.text = "";
+            box.tries = 0;
+            box.next = millis() + TG_NOTIFY_CHAT_MS;
+            _notifyStats.sent++;
+        } else if (++box.tries >= TG_NOTIFY_RETRY_COUNT) {
+            Log.error(F("TG"), String(F("Failed to notify chat: ")) + String(_users[i].chatId));
+            box.text = "";
+            box.tries = 0;
+            _notifyStats.failed++;
+        } else {
+            box.next = millis() + min((unsigned)(TG_NOTIFY_RETRY_MS << (box.tries - 1)), (unsigned)TG_NOTIFY_RETRY_MAX_MS);
+        }
+
+        /*
+         * One message per pass keeps below the global rate limit
+         */
+
+        break;
+    }
+    unlock();
+}
+
+size_t TgBotClass::_hashChatId(int64_t chatId) const
+{
+    uint64_t    h = (uint64_t)chatId;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+
+    return (size_t)h & (TG_USERS_HASH_SIZE - 1);
+}
+
+void TgBotClass::_buildIndex()
+{
+    for (size_t i = 0; i < TG_USERS_HASH_SIZE; i++) {
+        _usersIndex[i] = TG_USERS_HASH_NONE;
+    }
+
+    for (size_t i = 0; i < _users.size(); i++) {
+        size_t  slot;
+
+        if (!_users[i].enabled || _users[i].chatId == 0) continue;
+
+        slot = _hashChatId(_users[i].chatId);
+        while (_usersIndex[slot] != TG_USERS_HASH_NONE) {
+            if (_users[_usersIndex[slot]].chatId == _users[i].chatId) break;
+            slot = (slot + 1) & (TG_USERS_HASH_SIZE - 1);
+        }
+        if (_usersIndex[slot] == TG_USERS_HASH_NONE) {
+            _usersIndex[slot] = i;
+        }
+    }
+}
+
 void TgBotClass::_backMenu(TgUser *user)
 {
     switch (user->level) {
@@ -192,12 +655,89 @@ bool TgBotClass::_processLevel(TgUser *user, const String &msg)
     return false;
 }
 
+void TgBotClass::_queryHandler(fb::Update& upd)
+{
+    TgUser                      *user;
+    std::vector<TgSocketState>  socks;
+    unsigned                    version;
+    fb::TextEdit                edit;
+    size_t                      sockId;
+    char                        action;
+    int                         sep;
+
+    auto id = upd.query().from().id().toInt64();
+    String data = upd.query().data().toString();
+
+    _lastID = id;
+
+    if (!getUserByChatId(id, &user)) {
+        answerCallbackQuery(upd.query().id(), F("Доступ запрещён"), true);
+        return;
+    }
+
+    /*
+     * Callback data is "s:<socket id>:<action>", id 0 selects all
+     * sockets, action is 't' toggle, '1' on, '0' off or 'r' refresh.
+     */
+
+    sep = data.indexOf(':', 2);
+    if (!data.startsWith(F("s:")) || sep < 0 || sep + 1 >= (int)data.length()) {
+        answerCallbackQuery(upd.query().id());
+        return;
+    }
+    sockId = data.substring(2, sep).toInt();
+    action = data[sep + 1];
+
+    _getSockets(socks, version);
+
+    for (auto &socket : socks) {
+        bool status = socket.status;
+
+        if (sockId != 0 && socket.id != sockId) continue;
+
+        switch (action) {
+            case 't':
+                status = !socket.status;
+                break;
+
+            case '1':
+                status = true;
+                break;
+
+            case '0':
+                status = false;
+                break;
+
+            default:
+                break;
+        }
+
+        if (status != socket.status && _control({ .type = TG_CTRL_SOCKET, .id = socket.id, .status = status })) {
+            socket.status = status;
+        }
+    }
+
+    answerCallbackQuery(upd.query().id());
+
+    edit.chatID = upd.query().message().chat().id();
+    edit.messageID = upd.query().message().id();
+    edit.mode = fb::Message::Mode::HTML;
+    edit.text = _socketsText(socks);
+    edit.setInlineMenu(_getSocketsMenu(socks, version));
+    editText(edit);
+}
+
 void TgBotClass::_updateHandler(fb::Update& upd)
 {
     bool    changeLvl = false;
     TgUser  *user;
 
-    auto id = upd.message().from().id().toInt32();
+    if (upd.isQuery()) {
+        _queryHandler(upd);
+        return;
+    }
+
+    auto id = upd.message().from().id().toInt64();
     auto msg = upd.message().text().decodeUnicode();
 
     _lastID = id;
@@ -222,7 +762,6 @@ void TgBotClass::_updateHandler(fb::Update& upd)
 bool TgBotClass::_mainHandler(TgUser *user, const String &msg)
 {
     fb::Message resp;
-    fb::Menu    menu;
 
     resp.chatID = user->chatId;
     resp.mode = fb::Message::Mode::HTML;
@@ -233,14 +772,7 @@ bool TgBotClass::_mainHandler(TgUser *user, const String &msg)
         return true;
     }
 
-    menu.addButton(F("Я дома"));
-    menu.addButton(F("Ушёл"));
-    menu.newRow();
-
-    menu.addButton("Розетки");
-    menu.newRow();
-
-    resp.setMenu(menu);
+    resp.setMenu(_getMenu(TG_MENU_MAIN));
     sendMessage(resp);
 
     return false;
@@ -249,16 +781,12 @@ bool TgBotClass::_mainHandler(TgUser *user, const String &msg)
 bool TgBotClass::_meteoHandler(TgUser *user, const String &msg)
 {
     fb::Message resp;
-    fb::Menu    menu;
 
     resp.chatID = user->chatId;
     resp.mode = fb::Message::Mode::HTML;
     resp.text = F("<b>Метео</b>");
 
-    menu.addButton(F("Обновить"));
-    menu.addButton(F("Назад"));
-
-    resp.setMenu(menu);
+    resp.setMenu(_getMenu(TG_MENU_METEO));
     sendMessage(resp);
     return false;
 }
@@ -266,16 +794,12 @@ bool TgBotClass::_meteoHandler(TgUser *user, const String &msg)
 bool TgBotClass::_securityHandler(TgUser *user, const String &msg)
 {
     fb::Message resp;
-    fb::Menu    menu;
 
     resp.chatID = user->chatId;
     resp.mode = fb::Message::Mode::HTML;
     resp.text = F("<b>Охрана</b>");
 
-    menu.addButton(F("Обновить"));
-    menu.addButton(F("Назад"));
-
-    resp.setMenu(menu);
+    resp.setMenu(_getMenu(TG_MENU_SECURITY));
     sendMessage(resp);
     return false;
 }
@@ -283,16 +807,12 @@ bool TgBotClass::_securityHandler(TgUser *user, const String &msg)
 bool TgBotClass::_camsHandler(TgUser *user, const String &msg)
 {
     fb::Message resp;
-    fb::Menu    menu;
 
     resp.chatID = user->chatId;
     resp.mode = fb::Message::Mode::HTML;
     resp.text = F("<b>Камеры</b>");
 
-    menu.addButton(F("Обновить"));
-    menu.addButton(F("Назад"));
-
-    resp.setMenu(menu);
+    resp.setMenu(_getMenu(TG_MENU_CAMS));
     sendMessage(resp);
     return false;
 }
@@ -300,74 +820,49 @@ bool TgBotClass::_camsHandler(TgUser *user, const String &msg)
 bool TgBotClass::_tanksHandler(TgUser *user, const String &msg)
 {
     fb::Message resp;
-    fb::Menu    menu;
 
     resp.chatID = user->chatId;
     resp.mode = fb::Message::Mode::HTML;
     resp.text = F("<b>Баки</b>");
 
-    menu.addButton(F("Обновить"));
-    menu.addButton(F("Назад"));
-
-    resp.setMenu(menu);
+    resp.setMenu(_getMenu(TG_MENU_TANKS));
     sendMessage(resp);
     return false;
 }
 
 bool TgBotClass::_socketsHandler(TgUser *user, const String &msg)
 {
-    fb::Message             resp;
-    fb::Menu                menu;
-    std::vector<Socket *>   socks;
+    fb::Message                 resp;
+    std::vector<TgSocketState>  socks;
+    unsigned                    version;
 
-    resp.chatID = user->chatId;
-    resp.mode = fb::Message::Mode::HTML;
-
-    resp.text.concat(F("<b>РОЗЕТКИ:</b>\n\n"));
-
-    menu.addButton(F("Назад"));
-    menu.addButton(F("Статус"));
-    menu.addButton(F("Вкл.все"));
-    menu.addButton(F("Откл.все"));
-    menu.newRow();
-
-    SocketCtrl.getEnabledSockets(socks);
-
-    for (auto *socket : socks) {
-        if (msg == socket->name) {
-            SocketCtrl.setStatus(socket, !socket->status, true);
-        } else if (msg == "Вкл.все") {
-            SocketCtrl.setStatus(socket, true, true);
-        } else if (msg == "Откл.все") {
-            SocketCtrl.setStatus(socket, false, true);
-        }
-    }
+    /*
+     * Sockets are switched from the inline keyboard of this message,
+     * the user stays in the main menu.
+     */
 
-    for (auto *socket : socks) {
-        resp.text += "<b>" + socket->name + ":</b> " + (socket->status ? F("Включен") : F("Отключен")) + "\n";
-        menu.addButton(socket->name);
-        menu.newRow();
-    }
+    _getSockets(socks, version);
 
-    resp.setMenu(menu);
+    resp.chatID = user->chatId;
+    resp.mode = fb::Message::Mode::HTML;
+    resp.text = _socketsText(socks);
+    resp.setInlineMenu(_getSocketsMenu(socks, version));
     sendMessage(resp);
 
+    user->level = TG_MENU_MAIN;
+
     return false;
 }
 
 bool TgBotClass::_lightsHandler(TgUser *user, const String &msg)
 {
     fb::Message resp;
-    fb::Menu    menu;
 
     resp.chatID = user->chatId;
     resp.mode = fb::Message::Mode::HTML;
     resp.text = F("<b>Полив</b>");
 
-    menu.addButton(F("Обновить"));
-    menu.addButton(F("Назад"));
-
-    resp.setMenu(menu);
+    resp.setMenu(_getMenu(TG_MENU_LIGHTS));
     auto res = sendMessage(resp);
     return false;
 }
@@ -375,16 +870,12 @@ bool TgBotClass::_lightsHandler(TgUser *user, const String &msg)
 bool TgBotClass::_wateringHandler(TgUser *user, const String &msg)
 {
     fb::Message resp;
-    fb::Menu    menu;
 
     resp.chatID = user->chatId;
     resp.mode = fb::Message::Mode::HTML;
     resp.text = F("<b>Полив</b>");
 
-    menu.addButton(F("Обновить"));
-    menu.addButton(F("Назад"));
-
-    resp.setMenu(menu);
+    resp.setMenu(_getMenu(TG_MENU_WATERING));
     auto res = sendMessage(resp);
     return false;
 }
@@ -392,16 +883,12 @@ bool TgBotClass::_wateringHandler(TgUser *user, const String &msg)
 bool TgBotClass::_thermsHandler(TgUser *user, const String &msg)
 {
     fb::Message resp;
-    fb::Menu    menu;
 
     resp.chatID = user->chatId;
     resp.mode = fb::Message::Mode::HTML;
     resp.text = F("<b>Термоконтроль</b>");
 
-    menu.addButton(F("Обновить"));
-    menu.addButton(F("Назад"));
-
-    resp.setMenu(menu);
+    resp.setMenu(_getMenu(TG_MENU_THERMS));
     sendMessage(resp);
     return false;
 }
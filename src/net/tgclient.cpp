@@ -0,0 +1,263 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "net/tgclient.hpp"
+#include "utils/log.hpp"
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+TgClient::TgClient()
+{
+    setInsecure();
+}
+
+int TgClient::connect(const char *host, uint16_t port)
+{
+    unsigned    start;
+    int         res;
+
+    _timerReq = millis();
+    _waiting = true;
+    _begin();
+
+    if (WiFiClientSecure::connected() && _port == port && strcmp(_host, host) == 0) {
+        _stats.reuses++;
+        return 1;
+    }
+
+    WiFiClientSecure::stop();
+
+    if (!_resolve(host)) {
+        Log.error(F("TG"), String(F("Failed to resolve host: ")) + host);
+        _waiting = false;
+        return 0;
+    }
+
+    start = millis();
+    res = WiFiClientSecure::connect(_ip, port, host, nullptr, nullptr, nullptr);
+    if (res != 1) {
+        _timerDns = 0;
+        _waiting = false;
+        return res;
+    }
+
+    _stats.handshakes++;
+    _stats.lastHandshake = millis() - start;
+    strncpy(_host, host, TG_CLIENT_HOST_LEN - 1);
+    _port = port;
+
+    return res;
+}
+
+int TgClient::available()
+{
+    int res = WiFiClientSecure::available();
+
+    if (_waiting && res > 0) {
+        _waiting = false;
+        _stats.requests++;
+        _stats.lastLatency = millis() - _timerReq;
+        _stats.totalLatency += _stats.lastLatency;
+    }
+
+    return res;
+}
+
+int TgClient::read()
+{
+    int     res = WiFiClientSecure::read();
+    uint8_t c;
+
+    if (res >= 0) {
+        c = res;
+        _feed(&c, 1);
+    }
+    return res;
+}
+
+int TgClient::read(uint8_t *buf, size_t size)
+{
+    int res = WiFiClientSecure::read(buf, size);
+
+    if (res > 0) {
+        _feed(buf, res);
+    }
+    return res;
+}
+
+void TgClient::stop()
+{
+    /*
+     * Stop also aborts a pending long poll or a response read only in
+     * part. Keep the TLS session just when the response was complete,
+     * otherwise the next request would read the rest of this one.
+     */
+
+    if ((_http == TG_HTTP_DONE || _http == TG_HTTP_IDLE) && _keepAlive &&
+        WiFiClientSecure::available() == 0) {
+        _http = TG_HTTP_IDLE;
+        _waiting = false;
+        return;
+    }
+    close();
+}
+
+void TgClient::close()
+{
+    WiFiClientSecure::stop();
+    _host[0] = '\0';
+    _port = 0;
+    _http = TG_HTTP_IDLE;
+    _keepAlive = true;
+    _waiting = false;
+}
+
+const TgClientStats &TgClient::getStats() const
+{
+    return _stats;
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void TgClient::_begin()
+{
+    _http = TG_HTTP_HEADERS;
+    _lineLen = 0;
+    _remain = 0;
+    _hasLength = false;
+    _chunked = false;
+}
+
+void TgClient::_feed(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+
+        switch (_http) {
+            case TG_HTTP_BODY:
+                if (_hasLength && --_remain == 0) {
+                    _http = TG_HTTP_DONE;
+                }
+                break;
+
+            case TG_HTTP_CHUNK_DATA:
+                if (--_remain == 0) {
+                    _http = TG_HTTP_CHUNK_END;
+                }
+                break;
+
+            case TG_HTTP_CHUNK_END:
+                if (c == '\n') {
+                    _http = TG_HTTP_CHUNK_SIZE;
+                }
+                break;
+
+            case TG_HTTP_HEADERS:
+            case TG_HTTP_CHUNK_SIZE:
+            case TG_HTTP_TRAILER:
+                if (c == '\n') {
+                    _line[_lineLen] = '\0';
+                    _lineDone();
+                    _lineLen = 0;
+                } else if (c != '\r' && _lineLen < TG_CLIENT_LINE_LEN - 1) {
+                    _line[_lineLen++] = tolower(c);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+void TgClient::_lineDone()
+{
+    switch (_http) {
+        case TG_HTTP_HEADERS:
+            if (_lineLen > 0) {
+                _header();
+            } else if (_chunked) {
+                _http = TG_HTTP_CHUNK_SIZE;
+            } else if (_hasLength && _remain == 0) {
+                _http = TG_HTTP_DONE;
+            } else {
+                /*
+                 * No length means the body ends with the connection
+                 */
+
+                if (!_hasLength) {
+                    _keepAlive = false;
+                }
+                _http = TG_HTTP_BODY;
+            }
+            break;
+
+        case TG_HTTP_CHUNK_SIZE:
+            _remain = strtoul(_line, nullptr, 16);
+            _http = (_remain == 0) ? TG_HTTP_TRAILER : TG_HTTP_CHUNK_DATA;
+            break;
+
+        case TG_HTTP_TRAILER:
+            if (_lineLen == 0) {
+                _http = TG_HTTP_DONE;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void TgClient::_header()
+{
+    if (strncmp(_line, "content-length:", 15) == 0) {
+        _remain = strtoul(_line + 15, nullptr, 10);
+        _hasLength = true;
+    } else if (strncmp(_line, "transfer-encoding:", 18) == 0) {
+        _chunked = (strstr(_line, "chunked") != nullptr);
+    } else if (strncmp(_line, "connection:", 11) == 0) {
+        _keepAlive = (strstr(_line, "close") == nullptr);
+    } else if (strncmp(_line, "http/", 5) == 0) {
+        _hasLength = false;
+        _chunked = false;
+        _keepAlive = true;
+    }
+}
+
+bool TgClient::_resolve(const char *host)
+{
+    /*
+     * Resolved name is kept apart from the session host, which close()
+     * drops on every aborted response.
+     */
+
+    if (_timerDns != 0 && millis() - _timerDns < TG_CLIENT_DNS_TTL_MS && strcmp(_dnsHost, host) == 0) {
+        return true;
+    }
+
+    _stats.dnsLookups++;
+    if (!WiFi.hostByName(host, _ip)) {
+        _timerDns = 0;
+        return false;
+    }
+    strncpy(_dnsHost, host, TG_CLIENT_HOST_LEN - 1);
+    _timerDns = millis();
+
+    return true;
+}
@@ -0,0 +1,124 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#include "net/udpstream.hpp"
+#include "net/core/wifi.hpp"
+#include "utils/log.hpp"
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PUBLIC FUNCTIONS                         */
+/*                                                                   */
+/*********************************************************************/
+
+void UdpStreamClass::setEnabled(bool status)
+{
+    _enabled = status;
+}
+
+bool UdpStreamClass::getEnabled() const
+{
+    return _enabled;
+}
+
+void UdpStreamClass::setTarget(const IPAddress &ip, uint16_t port)
+{
+    _ip = ip;
+    _port = port;
+}
+
+const IPAddress &UdpStreamClass::getIP() const
+{
+    return _ip;
+}
+
+uint16_t UdpStreamClass::getPort() const
+{
+    return _port;
+}
+
+void UdpStreamClass::setRate(unsigned rate)
+{
+    _rate = constrain(rate, 1, UDP_STREAM_RATE_MAX);
+}
+
+unsigned UdpStreamClass::getRate() const
+{
+    return _rate;
+}
+
+const UdpStreamStats &UdpStreamClass::getStats() const
+{
+    return _stats;
+}
+
+void UdpStreamClass::begin()
+{
+    if (!_enabled || _ip == IPAddress()) return;
+
+    memset(&_frame, 0x0, sizeof(UdpFrame));
+    _frame.magic = UDP_STREAM_MAGIC;
+    _frame.version = UDP_STREAM_VERSION;
+    _frame.size = sizeof(UdpFrame);
+
+    _period = 1000000UL / _rate;
+    _next = micros();
+    _running = true;
+
+    Log.info(F("UDP"), String(F("Streaming telemetry to ")) + _ip.toString() + ":" + String(_port) +
+                        String(F(" at ")) + String(_rate) + String(F(" Hz, frame ")) +
+                        String(sizeof(UdpFrame)) + String(F(" bytes")));
+}
+
+void UdpStreamClass::loop()
+{
+    if (!_running) return;
+
+    if ((int32_t)(micros() - _next) < 0) {
+        return;
+    }
+
+    /*
+     * Next slot is counted from the schedule, not from now, so the
+     * rate does not drift with the loop time. A lost slot is skipped.
+     */
+
+    _next += _period;
+    if ((int32_t)(micros() - _next) >= 0) {
+        _stats.late++;
+        _next = micros() + _period;
+    }
+
+    if (Wireless.getStatus() == WL_CONNECTED) {
+        _send();
+    }
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                          PRIVATE FUNCTIONS                        */
+/*                                                                   */
+/*********************************************************************/
+
+void UdpStreamClass::_send()
+{
+    _frame.seq++;
+    _frame.time = millis();
+    RegImage.read(_frame.image);
+
+    if (_udp.writeTo((const uint8_t *)&_frame, sizeof(UdpFrame), _ip, _port) == sizeof(UdpFrame)) {
+        _stats.sent++;
+    } else {
+        _stats.failed++;
+    }
+}
+
+UdpStreamClass UdpStream;
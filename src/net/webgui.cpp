@@ -203,7 +203,7 @@ void WebGUIClass::_buildTgBotPage(sets::Builder& b)
                 TgBot.setPollMode(TgBot.getPollMode(), b.build.value.toInt32());
                 TgBot.begin();
             }
-            b.Label(WEB_GUI_TG_LAST_ID, F("LastID"), String(TgBot.getLastID()));
+            b.Label(WEB_GUI_TG_LAST_ID, F("LastID"), String((long long)TgBot.getLastID()));
         }
 
         if (b.beginMenu(F("Настройка"))) {
@@ -239,11 +239,14 @@ void WebGUIClass::_buildTgBotPage(sets::Builder& b)
                 if (b.Button(F("Применить"))) {
                     TgUser *user;
                     if (TgBot.getUser(_tgUser.curUser, &user)) {
+                        TgBot.lock();
                         user->name = _tgUser.Name;
                         user->enabled = _tgUser.Enabled;
                         user->admin = _tgUser.Admin;
                         user->chatId = _tgUser.ChatID;
                         user->notify = _tgUser.Notify;
+                        TgBot.updateUsers();
+                        TgBot.unlock();
                         b.reload();
                     }
                 }
@@ -270,7 +273,7 @@ void WebGUIClass::_buildTgBotPage(sets::Builder& b)
     for (auto *user : users) {
         if (b.beginGroup("Пользователь #" +String(i))) {
             b.Label(su::SH(("tg_user_name_"+String(i)).c_str()), "Имя", user->name);
-            b.Label(su::SH(("tg_user_chid_"+String(i)).c_str()), "ChatID", String(user->chatId));
+            b.Label(su::SH(("tg_user_chid_"+String(i)).c_str()), "ChatID", String((long long)user->chatId));
             b.LED(su::SH(("tg_user_admin_"+String(i)).c_str()), "Админ", user->admin);
             b.LED(su::SH(("tg_user_ntf_"+String(i)).c_str()), "Уведомления", user->notify);
             b.endGroup();
@@ -304,7 +307,7 @@ void WebGUIClass::_updateTgBotPage(sets::Updater& upd)
     size_t i = 1;
     for (auto *user : users) {
         upd.update(su::SH(("tg_user_name_"+String(i)).c_str()), user->name);
-        upd.update(su::SH(("tg_user_chid_"+String(i)).c_str()), user->chatId);
+        upd.update(su::SH(("tg_user_chid_"+String(i)).c_str()), String((long long)user->chatId));
         upd.update(su::SH(("tg_user_admin_"+String(i)).c_str()), user->admin);
         upd.update(su::SH(("tg_user_ntf_"+String(i)).c_str()), user->notify);
         i++;
@@ -435,6 +438,7 @@ void WebGUIClass::_buildSocketsPage(sets::Builder& b)
                     if (SocketCtrl.getSocket(_socket.curSock, &sock)) {
                         sock->name = _socket.Name;
                         sock->enabled = _socket.Enabled;
+                        TgBot.invalidateMenus();
                         bt = 1; rl = 1;
                         for (auto pin : pins) {
                             if (pin->type == GPIO_TYPE_INPUT) {
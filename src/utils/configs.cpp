@@ -18,6 +18,11 @@
 #include "core/ifaces/uart.hpp"
 #include "net/tgbot.hpp"
 #include "net/apiserver.hpp"
+#include "net/modbustcp.hpp"
+#include "net/modbusrtu.hpp"
+#include "net/mqtt.hpp"
+#include "net/udpstream.hpp"
+#include "net/replica.hpp"
 #include "controllers/meteo/meteo.hpp"
 #include "controllers/meteo/sensors/msensor.hpp"
 #include "controllers/meteo/sensors/ds18b20.hpp"
@@ -36,8 +41,6 @@
 
 bool ConfigsClass::begin()
 {
-    bool        isOk = false;
-
     _initInterfaces();
     Log.info(F("CFG"), "Interfaces initialized");
 
@@ -60,28 +63,37 @@ bool ConfigsClass::begin()
         }
     }*/
 
+    if (!_mounted) {
+        mount();
+    }
+
+    if (!LittleFS.exists(CONFIGS_STARTUP_FILE))
+    {
+        return _initDevice();
+    }
+
+    return _readAll(CFG_SRC_FLASH);
+}
+
+bool ConfigsClass::mount()
+{
     Log.warning(F("CFG"), F("SD card not found. Trying to read from flash memory"));
 
     _src = CFG_SRC_FLASH;
 
 #ifdef ESP32
-    isOk = LittleFS.begin(true);
+    _mounted = LittleFS.begin(true);
 #else
-    isOk = LittleFS.begin();
+    _mounted = LittleFS.begin();
 #endif
 
-    if (isOk) {
+    if (_mounted) {
         Log.info(F("CFG"), F("Flash memory initialized"));
     } else {
         Log.error(F("CFG"), F("Failed to flash memory"));
     }
 
-    if (!LittleFS.exists(CONFIGS_STARTUP_FILE))
-    {
-        return _initDevice();
-    }
-
-    return _readAll(CFG_SRC_FLASH);
+    return _mounted;
 }
 
 bool ConfigsClass::writeAll()
@@ -214,6 +226,23 @@ bool ConfigsClass::_readAll(ConfigsSource src)
     Wireless.setHostname(jwifi[F("hostname")]);
     Wireless.setAP(jwifi[F("ap")]);
     Wireless.setEnabled(jwifi[F("enabled")]);
+    if (!jwifi[F("fast")].isNull()) {
+        Wireless.setFastConnect(jwifi[F("fast")]);
+    }
+    if (!jwifi[F("ip")].isNull()) {
+        IPAddress ip, subnet, gateway, dns;
+
+        if (ip.fromString(jwifi[F("ip")].as<String>()) &&
+            subnet.fromString(jwifi[F("subnet")].as<String>()) &&
+            gateway.fromString(jwifi[F("gateway")].as<String>())) {
+            if (!dns.fromString(jwifi[F("dns")].as<String>())) {
+                dns = gateway;
+            }
+            Wireless.setStaticIP(ip, subnet, gateway, dns);
+        } else {
+            Log.error(F("CFG"), F("Wrong Wi-Fi static IP configuration"));
+        }
+    }
 
     /*
      * PLC configurations
@@ -223,6 +252,85 @@ bool ConfigsClass::_readAll(ConfigsSource src)
     Plc.setFanEnabled(jplc[F("fan")]);
     Plc.setName(jplc[F("name")]);
 
+    /*
+     * GSM modem configurations
+     */
+
+    auto jgsm = doc[F("gsm")];
+    GsmModem.setEnabled(jgsm[F("enabled")]);
+    GsmModem.clearRecipients();
+    for (auto jphone : jgsm[F("recipients")].as<JsonArray>()) {
+        GsmModem.addRecipient(jphone.as<String>());
+    }
+
+    /*
+     * Modbus configurations
+     */
+
+    auto jmodbus = doc[F("modbus")];
+    ModbusTcp.setEnabled(jmodbus[F("tcp")]);
+    ModbusRtu.setEnabled(jmodbus[F("rtu")]);
+    if (jmodbus[F("address")].is<uint8_t>()) {
+        ModbusRtu.setAddress(jmodbus[F("address")]);
+    }
+    ModbusRtu.setDePin(jmodbus[F("de")] | MODBUS_RTU_DE_NONE);
+
+    /*
+     * MQTT configurations
+     */
+
+    auto jmqtt = doc[F("mqtt")];
+    Mqtt.setEnabled(jmqtt[F("enabled")]);
+    Mqtt.setServer(jmqtt[F("host")] | "", jmqtt[F("port")] | MQTT_DEFAULT_PORT);
+    Mqtt.setCreds(jmqtt[F("user")] | "", jmqtt[F("passwd")] | "");
+    if (jmqtt[F("prefix")].is<const char *>()) {
+        Mqtt.setPrefix(jmqtt[F("prefix")].as<String>());
+    }
+    if (jmqtt[F("period")].is<unsigned>()) {
+        Mqtt.setPeriod(jmqtt[F("period")]);
+    }
+
+    /*
+     * UDP telemetry configurations
+     */
+
+    auto        judp = doc[F("udp")];
+    IPAddress   udpIp;
+
+    UdpStream.setEnabled(judp[F("enabled")]);
+    if (judp[F("host")].is<const char *>() && udpIp.fromString(judp[F("host")].as<const char *>())) {
+        UdpStream.setTarget(udpIp, judp[F("port")] | UDP_STREAM_DEFAULT_PORT);
+    }
+    UdpStream.setRate(judp[F("rate")] | UDP_STREAM_DEFAULT_RATE);
+
+    /*
+     * Replication configurations
+     */
+
+    auto        jrepl = doc[F("replica")];
+    IPAddress   replIp;
+
+    Replica.setEnabled(jrepl[F("enabled")]);
+    Replica.setNode(jrepl[F("node")] | REPLICA_DEFAULT_NODE);
+    if (!replIp.fromString(jrepl[F("group")] | String(REPLICA_DEFAULT_GROUP))) {
+        replIp.fromString(REPLICA_DEFAULT_GROUP);
+    }
+    Replica.setGroup(replIp, jrepl[F("port")] | REPLICA_DEFAULT_PORT);
+
+    Replica.clearMap();
+    for (auto jmap : jrepl[F("map")].as<JsonArray>()) {
+        bool ok;
+
+        if (jmap[F("socket")].is<unsigned>()) {
+            ok = Replica.addMap(jmap[F("pin")], jmap[F("node")], REPLICA_SRC_SOCKET, jmap[F("socket")].as<unsigned>() - 1);
+        } else {
+            ok = Replica.addMap(jmap[F("pin")], jmap[F("node")], REPLICA_SRC_INPUT, jmap[F("input")]);
+        }
+        if (!ok) {
+            Log.error(F("CFG"), String(F("Failed to map virtual pin: ")) + jmap[F("pin")].as<String>());
+        }
+    }
+
     /*
      * Telegram configurations
      */
@@ -244,7 +352,7 @@ bool ConfigsClass::_readAll(ConfigsSource src)
         TgUser  user;
         memset(&user, 0x0, sizeof(TgUser));
         user.name = usr[F("name")].as<String>();
-        user.chatId = usr[F("id")];
+        user.chatId = usr[F("id")].as<int64_t>();
         user.notify = usr[F("notify")];
         user.admin = usr[F("admin")];
         user.enabled = true;
@@ -301,6 +409,15 @@ bool ConfigsClass::_generateRunning(JsonDocument &doc)
     jwifi[F("ssid")] = Wireless.getSSID();
     jwifi[F("passwd")] = Wireless.getPasswd();
     jwifi[F("ap")] = Wireless.getAP();
+    jwifi[F("fast")] = Wireless.getFastConnect();
+
+    IPAddress ip, subnet, gateway, dns;
+    if (Wireless.getStaticIP(ip, subnet, gateway, dns)) {
+        jwifi[F("ip")] = ip.toString();
+        jwifi[F("subnet")] = subnet.toString();
+        jwifi[F("gateway")] = gateway.toString();
+        jwifi[F("dns")] = dns.toString();
+    }
 
     /*
      * GSM modem configurations
@@ -308,6 +425,65 @@ bool ConfigsClass::_generateRunning(JsonDocument &doc)
 
     auto jgsm = doc[F("gsm")];
     jgsm[F("enabled")] = GsmModem.getEnabled();
+    for (auto &phone : GsmModem.getRecipients()) {
+        jgsm[F("recipients")].add(phone);
+    }
+
+    /*
+     * Modbus configurations
+     */
+
+    auto jmodbus = doc[F("modbus")];
+    jmodbus[F("tcp")] = ModbusTcp.getEnabled();
+    jmodbus[F("rtu")] = ModbusRtu.getEnabled();
+    jmodbus[F("address")] = ModbusRtu.getAddress();
+    jmodbus[F("de")] = ModbusRtu.getDePin();
+
+    /*
+     * MQTT configurations
+     */
+
+    auto jmqtt = doc[F("mqtt")];
+    jmqtt[F("enabled")] = Mqtt.getEnabled();
+    jmqtt[F("host")] = Mqtt.getHost();
+    jmqtt[F("port")] = Mqtt.getPort();
+    jmqtt[F("user")] = Mqtt.getUser();
+    jmqtt[F("passwd")] = Mqtt.getPasswd();
+    jmqtt[F("prefix")] = Mqtt.getPrefix();
+    jmqtt[F("period")] = Mqtt.getPeriod();
+
+    /*
+     * UDP telemetry configurations
+     */
+
+    auto judp = doc[F("udp")];
+    judp[F("enabled")] = UdpStream.getEnabled();
+    judp[F("host")] = UdpStream.getIP().toString();
+    judp[F("port")] = UdpStream.getPort();
+    judp[F("rate")] = UdpStream.getRate();
+
+    /*
+     * Replication configurations
+     */
+
+    auto jrepl = doc[F("replica")];
+    jrepl[F("enabled")] = Replica.getEnabled();
+    jrepl[F("node")] = Replica.getNode();
+    jrepl[F("group")] = Replica.getGroup().toString();
+    jrepl[F("port")] = Replica.getPort();
+
+    auto jmaps = jrepl[F("map")];
+    for (size_t i = 0; i < Replica.getMapCount(); i++) {
+        const ReplicaMap &map = Replica.getMap(i);
+
+        jmaps[i][F("pin")] = map.pin->id;
+        jmaps[i][F("node")] = map.node;
+        if (map.source == REPLICA_SRC_SOCKET) {
+            jmaps[i][F("socket")] = map.index + 1;
+        } else {
+            jmaps[i][F("input")] = map.index;
+        }
+    }
 
     /*
      * Telegram Bot
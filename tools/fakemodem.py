@@ -0,0 +1,286 @@
+#!/usr/bin/env python3
+#
+# Programmable Logic Controller for ESP microcontrollers
+#
+# Copyright (C) 2024-2025 Denisov Foundation Limited
+# License: GPLv3
+#
+# Scripted SIM800-like modem for the GSM AT engine. Runs on a pseudo
+# terminal, or on a serial adapter wired to the board modem UART in
+# place of the real modem. Answers the bring-up and status commands,
+# emits URCs, accepts SMS through the '>' prompt and can inject
+# faults: slow replies, late prompts, failed sends, a hang that only
+# AT+CFUN=1,1 clears. Commands that
+# arrive while the modem waits for message text are reported, they
+# would have been sent as SMS body by a real modem.
+#
+
+import argparse
+import os
+import select
+import sys
+import termios
+import threading
+import time
+import tty
+
+BAUDS = {
+    9600: termios.B9600,
+    19200: termios.B19200,
+    38400: termios.B38400,
+    57600: termios.B57600,
+    115200: termios.B115200,
+}
+
+
+class FakeModem:
+    def __init__(self, fd, args):
+        self.fd = fd
+        self.args = args
+        self.lock = threading.Lock()
+        self.echo = True
+        self.charset = "GSM"
+        self.text_mode = False
+        self.sms_to = None
+        self.sms_body = bytearray()
+        self.sms_count = 0
+        self.hung = False
+        self.buf = bytearray()
+        self.stats = {"commands": 0, "errors": 0, "sms": 0, "sms_failed": 0,
+                      "cancelled": 0, "leaked": 0, "urcs": 0, "flood_bytes": 0, "resets": 0}
+
+    def write(self, data):
+        if isinstance(data, str):
+            data = data.encode()
+        with self.lock:
+            os.write(self.fd, data)
+
+    def reply(self, lines, final="OK"):
+        if self.args.delay > 0:
+            time.sleep(self.args.delay / 1000.0)
+        out = "".join("\r\n%s\r\n" % line for line in lines)
+        if final:
+            out += "\r\n%s\r\n" % final
+        self.write(out)
+
+    def log(self, text):
+        if not self.args.quiet:
+            print("[%.3f] %s" % (time.monotonic(), text), flush=True)
+
+    def feed(self, data):
+        for byte in data:
+            if self.text_mode:
+                self._text_byte(byte)
+                continue
+            if byte == 0x0D:
+                line = self.buf.decode(errors="replace").strip()
+                self.buf.clear()
+                if line:
+                    self._command(line)
+            elif byte != 0x0A:
+                self.buf.append(byte)
+
+    def _text_byte(self, byte):
+        if byte == 0x1A:
+            self.text_mode = False
+            self._sms_done()
+        elif byte == 0x1B:
+            self.text_mode = False
+            self.stats["cancelled"] += 1
+            self.log("SMS cancelled by ESC")
+        else:
+            self.sms_body.append(byte)
+            if byte == 0x0D and self.sms_body.strip().upper().startswith(b"AT"):
+                self.stats["leaked"] += 1
+                self.log("FAIL: command sent while waiting for SMS text: %r" % bytes(self.sms_body))
+
+    def _decode(self, value):
+        if self.charset != "UCS2":
+            return value
+        try:
+            return bytes.fromhex(value).decode("utf-16-be")
+        except ValueError:
+            return "<bad UCS2: %s>" % value
+
+    def _sms_done(self):
+        body = self.sms_body.decode(errors="replace")
+        self.sms_body.clear()
+        self.sms_count += 1
+        if self.args.sms_fail and self.sms_count % self.args.sms_fail == 0:
+            self.stats["sms_failed"] += 1
+            self.log("SMS to %s rejected" % self.sms_to)
+            self.reply([], "+CMS ERROR: 500")
+            return
+        self.stats["sms"] += 1
+        self.log("SMS to %s: %s" % (self.sms_to, self._decode(body)))
+        self.reply(["+CMGS: %d" % self.sms_count])
+
+    def _command(self, line):
+        if self.echo:
+            self.write(line + "\r")
+        if not line.upper().startswith("AT"):
+            self.log("ignored: %r" % line)
+            return
+
+        self.stats["commands"] += 1
+        self.log("<- %s" % line)
+        if line.upper().replace(" ", "") == "AT+CFUN=1,1":
+            self._reset()
+            return
+        if self.args.hang and self.stats["commands"] >= self.args.hang and not self.stats["resets"]:
+            if not self.hung:
+                self.log("modem hung")
+            self.hung = True
+        if self.hung:
+            return
+        lines = []
+        for cmd in self._split(line[2:]):
+            result = self._execute(cmd, lines)
+            if result is None:
+                return
+            if not result:
+                self.stats["errors"] += 1
+                self.reply(lines, "ERROR")
+                return
+        self.reply(lines)
+
+    def _reset(self):
+        self.stats["resets"] += 1
+        self.hung = False
+        self.echo = True
+        self.charset = "GSM"
+        self.text_mode = False
+        self.log("modem reset by AT+CFUN=1,1")
+        self.reply([])
+        time.sleep(self.args.reset_delay / 1000.0)
+        self.write("\r\nRDY\r\n\r\n+CFUN: 1\r\n\r\n+CPIN: READY\r\n")
+
+    def _split(self, cmds):
+        parts = [part.strip() for part in cmds.split(";")]
+        return [part for part in parts if part] or [""]
+
+    def _execute(self, cmd, lines):
+        up = cmd.upper()
+        args = self.args
+
+        if up in ("", "E1"):
+            self.echo = True if up == "E1" else self.echo
+        elif up == "E0":
+            self.echo = False
+        elif up.startswith("+CREG=") or up.startswith("+CMGF=") or up.startswith("+CSMP="):
+            pass
+        elif up == "+CPIN?":
+            lines.append("+CPIN: %s" % args.pin)
+        elif up == "+CREG?":
+            lines.append("+CREG: 1,%d" % args.reg)
+        elif up == "+CSQ":
+            lines.append("+CSQ: %d,0" % args.signal)
+        elif up == "+COPS?":
+            lines.append('+COPS: 0,0,"%s"' % args.operator)
+        elif up == "+GSN":
+            lines.append(args.imei)
+        elif up == "+CCID":
+            lines.append(args.ccid)
+        elif up.startswith("+CSCS="):
+            self.charset = cmd.split("=", 1)[1].strip('"').upper()
+        elif up.startswith("+CMGS="):
+            self.sms_to = self._decode(cmd.split("=", 1)[1].strip('"'))
+            self.sms_body.clear()
+            self.text_mode = True
+            threading.Thread(target=self._prompt, daemon=True).start()
+            return None
+        else:
+            return False
+        return True
+
+    def _prompt(self):
+        delay = self.args.prompt_delay if self.args.prompt_delay else self.args.delay
+        time.sleep(delay / 1000.0)
+        self.write("\r\n> ")
+
+    def urc(self, line):
+        self.stats["urcs"] += 1
+        self.write("\r\n%s\r\n" % line)
+
+
+def open_port(args):
+    if args.port:
+        fd = os.open(args.port, os.O_RDWR | os.O_NOCTTY)
+        attrs = termios.tcgetattr(fd)
+        attrs[4] = attrs[5] = BAUDS[args.baud]
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        tty.setraw(fd)
+        return fd, args.port
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    return master, os.ttyname(slave)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Scripted fake GSM modem")
+    parser.add_argument("--port", help="serial device wired to the board modem UART, pty when omitted")
+    parser.add_argument("--baud", type=int, default=115200, choices=sorted(BAUDS), help="serial speed")
+    parser.add_argument("--delay", type=int, default=50, help="reply delay, ms")
+    parser.add_argument("--prompt-delay", type=int, default=0, help="SMS prompt delay, ms")
+    parser.add_argument("--sms-fail", type=int, default=0, help="reject every Nth SMS")
+    parser.add_argument("--hang", type=int, default=0, help="stop answering from the Nth command until AT+CFUN=1,1")
+    parser.add_argument("--reset-delay", type=int, default=3000, help="reboot time after AT+CFUN=1,1, ms")
+    parser.add_argument("--pin", default="READY", help="+CPIN state")
+    parser.add_argument("--reg", type=int, default=1, help="+CREG registration status")
+    parser.add_argument("--signal", type=int, default=20, help="+CSQ signal level")
+    parser.add_argument("--operator", default="MegaFon", help="+COPS operator name")
+    parser.add_argument("--imei", default="861234567890123", help="+GSN reply")
+    parser.add_argument("--ccid", default="89701012345678901234", help="+CCID reply")
+    parser.add_argument("--urc-period", type=float, default=0, help="emit a URC every N seconds")
+    parser.add_argument("--flood", type=int, default=0, help="send N +CREG URC lines per second as UART load")
+    parser.add_argument("--quiet", action="store_true", help="log only the summary")
+    args = parser.parse_args()
+
+    fd, name = open_port(args)
+    modem = FakeModem(fd, args)
+    print("fake modem on %s" % name, flush=True)
+
+    urcs = ["+CREG: %d" % args.reg, "RING", '+CMTI: "SM",1']
+    next_urc = time.monotonic() + args.urc_period if args.urc_period else None
+    flood_line = b"\r\n+CREG: %d\r\n" % args.reg
+    flood_next = time.monotonic()
+    flood_start = flood_next
+    count = 0
+
+    try:
+        while True:
+            ready, _, _ = select.select([fd], [], [], 0.001 if args.flood else 0.05)
+            if ready:
+                try:
+                    data = os.read(fd, 1024)
+                except OSError:
+                    data = b""
+                if data:
+                    modem.feed(data)
+
+            now = time.monotonic()
+            if next_urc is not None and now >= next_urc:
+                modem.urc(urcs[count % len(urcs)])
+                count += 1
+                next_urc = now + args.urc_period
+            if args.flood:
+                while now >= flood_next:
+                    modem.write(flood_line)
+                    modem.stats["flood_bytes"] += len(flood_line)
+                    modem.stats["urcs"] += 1
+                    flood_next += 1.0 / args.flood
+    except KeyboardInterrupt:
+        pass
+
+    print("")
+    if args.flood:
+        elapsed = time.monotonic() - flood_start
+        print("flood: %d bytes in %.1f s, %.0f bytes/s" % (
+            modem.stats["flood_bytes"], elapsed, modem.stats["flood_bytes"] / elapsed))
+    print(", ".join("%s %d" % kv for kv in modem.stats.items()))
+    return 1 if modem.stats["leaked"] else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+#
+# Programmable Logic Controller for ESP microcontrollers
+#
+# Copyright (C) 2024-2025 Denisov Foundation Limited
+# License: GPLv3
+#
+# Host simulation of the PLC replication. Builds src/net/replica.cpp,
+# the firmware code itself, against the stand-ins in tools/replsim/shim
+# and runs several ReplicaClass instances on loopback: deltas, resync
+# on join, loss, restart, Wi-Fi return and timeouts are checked through
+# the mapped virtual pins and peer tables of every node. Options are
+# passed to the simulation, see -h. Exits with a non-zero status when
+# the build or a scenario fails.
+#
+
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+SOURCES = ["src/net/replica.cpp", "tools/replsim/replsim.cpp"]
+INCLUDES = ["tools/replsim/shim", "include"]
+
+
+def build(output):
+    cmd = [os.environ.get("CXX", "c++"), "-std=gnu++17", "-Wall", "-O1", "-o", output]
+    cmd += ["-I" + os.path.join(ROOT, path) for path in INCLUDES]
+    cmd += [os.path.join(ROOT, path) for path in SOURCES]
+    return subprocess.call(cmd) == 0
+
+
+def main():
+    with tempfile.TemporaryDirectory() as tmp:
+        binary = os.path.join(tmp, "replsim")
+        if not build(binary):
+            print("replsim: build failed", file=sys.stderr)
+            return 2
+        return subprocess.call([sys.argv[0]] + sys.argv[1:], executable=binary)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,560 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+
+/*
+ * Host simulation of replication: several instances of ReplicaClass from
+ * src/net/replica.cpp run on loopback against the stand-ins in shim/
+ * and are checked through their mapped virtual pins and peer tables.
+ * Built and started by tools/replsim.py.
+ */
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <random>
+#include <vector>
+
+#include "net/replica.hpp"
+#include "net/core/wifi.hpp"
+#include "utils/log.hpp"
+
+#define REPLSIM_MAP_INPUTS      3
+#define REPLSIM_MAP_SOCKETS     2
+#define REPLSIM_NODES_MAX       (1 + REPLICA_MAP_MAX / (REPLSIM_MAP_INPUTS + REPLSIM_MAP_SOCKETS))
+#define REPLSIM_PIN_BASE        300
+
+struct ReplSimNode {
+    uint8_t         node;
+    ReplicaClass    *replica;
+    RegImageData    image;
+    GpioPin         pins[REPLICA_MAP_MAX];
+    size_t          pinCount;
+    bool            running;
+    bool            linked;
+    double          loss;
+    unsigned        dropped;
+};
+
+static ReplSimNode              *current = nullptr;
+static std::vector<ReplSimNode> nodes;
+static std::vector<AsyncUDP *>  sockets;
+static std::mt19937             rng;
+static IPAddress                group(239, 255, 70, 1);
+static uint16_t                 port = REPLICA_DEFAULT_PORT;
+static bool                     unicast = false;
+static bool                     verbose = false;
+
+GpioClass       Gpio;
+RegImageClass   RegImage;
+WirelessClass   Wireless;
+LogClass        Log;
+
+/*********************************************************************/
+/*                                                                   */
+/*                          HOST STAND-INS                           */
+/*                                                                   */
+/*********************************************************************/
+
+uint32_t millis()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+uint32_t esp_random()
+{
+    return rng();
+}
+
+void GpioClass::write(GpioPin *pin, bool val)
+{
+    pin->state = val;
+}
+
+bool GpioClass::addVirtual(uint16_t id, GpioPin **pin)
+{
+    for (size_t i = 0; i < current->pinCount; i++) {
+        if (current->pins[i].id == id) {
+            *pin = &current->pins[i];
+            return true;
+        }
+    }
+    if (current->pinCount == REPLICA_MAP_MAX) {
+        return false;
+    }
+
+    *pin = &current->pins[current->pinCount++];
+    (*pin)->id = id;
+    (*pin)->state = true;
+    (*pin)->enabled = true;
+    return true;
+}
+
+void RegImageClass::read(RegImageData &data)
+{
+    data = current->image;
+}
+
+wl_status_t WirelessClass::getStatus() const
+{
+    return current->linked ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+static void logPrint(const char *type, const String &mod, const String &msg)
+{
+    if (verbose) {
+        printf("%8u node %u %s %s: %s\n", millis(), current->node, type, mod.c_str(), msg.c_str());
+    }
+}
+
+void LogClass::info(const String &mod, const String &msg)
+{
+    logPrint("INFO", mod, msg);
+}
+
+void LogClass::error(const String &mod, const String &msg)
+{
+    logPrint("ERROR", mod, msg);
+}
+
+void LogClass::warning(const String &mod, const String &msg)
+{
+    logPrint("WARN", mod, msg);
+}
+
+AsyncUDP::~AsyncUDP()
+{
+    close();
+}
+
+bool AsyncUDP::listenMulticast(const IPAddress &addr, uint16_t port)
+{
+    struct sockaddr_in  sa = {};
+    struct ip_mreq      mreq = {};
+    struct in_addr      lo = { htonl(INADDR_LOOPBACK) };
+    int                 on = 1;
+
+    close();
+    _fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+    if (_fd < 0) return false;
+
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+
+    /*
+     * Without a multicast route on lo every node listens on its own
+     * unicast port and a write is sent to each of them.
+     */
+
+    sa.sin_family = AF_INET;
+    if (unicast) {
+        _port = port + current->node;
+        sa.sin_addr = lo;
+    } else {
+        _port = port;
+        sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    }
+    sa.sin_port = htons(_port);
+    if (bind(_fd, (struct sockaddr *)&sa, sizeof(sa)) != 0) {
+        close();
+        return false;
+    }
+
+    if (!unicast) {
+        mreq.imr_multiaddr.s_addr = inet_addr(addr.toString().c_str());
+        mreq.imr_interface = lo;
+        if (setsockopt(_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0 ||
+            setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_IF, &lo, sizeof(lo)) != 0 ||
+            setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &on, sizeof(on)) != 0) {
+            close();
+            return false;
+        }
+    }
+
+    _owner = current;
+    sockets.push_back(this);
+    return true;
+}
+
+void AsyncUDP::onPacket(AuPacketHandlerFunction cb)
+{
+    _handler = cb;
+}
+
+size_t AsyncUDP::writeTo(const uint8_t *data, size_t len, const IPAddress &addr, uint16_t port)
+{
+    struct sockaddr_in  sa = {};
+    bool                sent = true;
+
+    if (_fd < 0) return 0;
+
+    sa.sin_family = AF_INET;
+    if (!unicast) {
+        sa.sin_addr.s_addr = inet_addr(addr.toString().c_str());
+        sa.sin_port = htons(port);
+        return (sendto(_fd, data, len, 0, (struct sockaddr *)&sa, sizeof(sa)) == (ssize_t)len) ? len : 0;
+    }
+
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (AsyncUDP *udp : sockets) {
+        sa.sin_port = htons(udp->_port);
+        sent &= (sendto(_fd, data, len, 0, (struct sockaddr *)&sa, sizeof(sa)) == (ssize_t)len);
+    }
+    return sent ? len : 0;
+}
+
+void AsyncUDP::close()
+{
+    if (_fd < 0) return;
+
+    ::close(_fd);
+    _fd = -1;
+    for (size_t i = 0; i < sockets.size(); i++) {
+        if (sockets[i] == this) {
+            sockets.erase(sockets.begin() + i);
+            break;
+        }
+    }
+}
+
+/*
+ * Hands every pending datagram to the node owning the socket, the same
+ * as the AsyncUDP task does on a board. A stopped node hears nothing,
+ * the loss ratio of a node drops its datagrams at random.
+ */
+void replSimPoll(unsigned timeout)
+{
+    struct pollfd       fds[REPLSIM_NODES_MAX];
+    AsyncUDP            *udps[REPLSIM_NODES_MAX];
+    size_t              count = 0;
+    uint8_t             buf[2048];
+    struct sockaddr_in  sa;
+    socklen_t           len;
+    ssize_t             size;
+
+    for (AsyncUDP *udp : sockets) {
+        fds[count].fd = udp->_fd;
+        fds[count].events = POLLIN;
+        udps[count++] = udp;
+    }
+    if (poll(fds, count, timeout) <= 0) return;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!(fds[i].revents & POLLIN)) continue;
+
+        for (;;) {
+            len = sizeof(sa);
+            size = recvfrom(udps[i]->_fd, buf, sizeof(buf), 0, (struct sockaddr *)&sa, &len);
+            if (size < 0) break;
+
+            ReplSimNode *owner = udps[i]->_owner;
+            if (!owner->running || !udps[i]->_handler) continue;
+            if (std::uniform_real_distribution<double>(0.0, 1.0)(rng) < owner->loss) {
+                owner->dropped++;
+                continue;
+            }
+
+            uint32_t        ip = ntohl(sa.sin_addr.s_addr);
+            AsyncUDPPacket  packet(buf, size, IPAddress(ip >> 24, ip >> 16, ip >> 8, ip));
+
+            current = owner;
+            udps[i]->_handler(packet);
+        }
+    }
+}
+
+/*********************************************************************/
+/*                                                                   */
+/*                             SCENARIOS                             */
+/*                                                                   */
+/*********************************************************************/
+
+/*
+ * Every node mirrors the first inputs and sockets of every other node
+ * on virtual pins, so the firmware output is what gets checked.
+ */
+static void nodeStart(ReplSimNode &sim, size_t total)
+{
+    uint16_t pin = REPLSIM_PIN_BASE;
+
+    current = &sim;
+    sim.replica = new ReplicaClass();
+    sim.replica->setEnabled(true);
+    sim.replica->setNode(sim.node);
+    sim.replica->setGroup(group, port);
+    for (uint8_t node = 1; node <= total; node++) {
+        if (node == sim.node) continue;
+
+        for (uint8_t i = 0; i < REPLSIM_MAP_INPUTS; i++) {
+            sim.replica->addMap(pin++, node, REPLICA_SRC_INPUT, i);
+        }
+        for (uint8_t i = 0; i < REPLSIM_MAP_SOCKETS; i++) {
+            sim.replica->addMap(pin++, node, REPLICA_SRC_SOCKET, i);
+        }
+    }
+    sim.replica->begin();
+    sim.running = true;
+}
+
+static void nodeRestart(ReplSimNode &sim, size_t total)
+{
+    current = &sim;
+    delete sim.replica;
+    sim.pinCount = 0;
+    nodeStart(sim, total);
+}
+
+static void setInput(ReplSimNode &sim, uint8_t index, bool pressed)
+{
+    if (pressed) {
+        sim.image.inputs |= (1ULL << index);
+    } else {
+        sim.image.inputs &= ~(1ULL << index);
+    }
+}
+
+static void setSocket(ReplSimNode &sim, uint8_t index, bool on)
+{
+    if (on) {
+        sim.image.coils |= (1UL << index);
+    } else {
+        sim.image.coils &= ~(1UL << index);
+    }
+}
+
+static void step(unsigned timeout)
+{
+    replSimPoll(timeout);
+    for (ReplSimNode &sim : nodes) {
+        if (sim.running) {
+            current = &sim;
+            sim.replica->loop();
+        }
+    }
+}
+
+static void run(unsigned ms)
+{
+    uint32_t start = millis();
+
+    while (millis() - start < ms) {
+        step(1);
+    }
+}
+
+static bool peerOf(const ReplSimNode &sim, uint8_t node, ReplicaPeer &peer)
+{
+    ReplicaPeer peers[REPLICA_PEERS_MAX];
+    size_t      count = sim.replica->getPeers(peers, REPLICA_PEERS_MAX);
+
+    for (size_t i = 0; i < count; i++) {
+        if (peers[i].node == node) {
+            peer = peers[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * A mirrored input is high while the remote button is released, a
+ * mirrored socket is high while the remote socket is on. A peer that
+ * is not followed leaves its pins idle.
+ */
+static bool mirrored(const ReplSimNode &sim, const ReplSimNode *remote)
+{
+    for (size_t i = 0; i < sim.replica->getMapCount(); i++) {
+        const ReplicaMap    &map = sim.replica->getMap(i);
+        bool                level;
+
+        if (remote != nullptr && map.node != remote->node) continue;
+
+        if (map.source == REPLICA_SRC_INPUT) {
+            level = (remote == nullptr || !(remote->image.inputs & (1ULL << map.index)));
+        } else {
+            level = (remote != nullptr && (remote->image.coils & (1UL << map.index)));
+        }
+        if (map.pin->state != level) return false;
+    }
+    return true;
+}
+
+static bool converged()
+{
+    ReplicaPeer peer;
+
+    for (const ReplSimNode &sim : nodes) {
+        if (!sim.running) continue;
+
+        for (const ReplSimNode &other : nodes) {
+            if (&other == &sim || !other.running) continue;
+
+            if (!peerOf(sim, other.node, peer) || !peer.online ||
+                peer.version != other.replica->getVersion() || !mirrored(sim, &other)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool released(const ReplSimNode &gone)
+{
+    ReplicaPeer peer;
+
+    for (const ReplSimNode &sim : nodes) {
+        if (&sim == &gone || !sim.running) continue;
+
+        if (peerOf(sim, gone.node, peer) && peer.online) return false;
+        for (size_t i = 0; i < sim.replica->getMapCount(); i++) {
+            const ReplicaMap &map = sim.replica->getMap(i);
+
+            if (map.node != gone.node) continue;
+            if (map.pin->state != (map.source == REPLICA_SRC_INPUT)) return false;
+        }
+    }
+    return true;
+}
+
+static bool scenario(const char *name, const std::function<bool()> &check, unsigned limit)
+{
+    uint32_t start = millis();
+
+    while (millis() - start < limit) {
+        if (check()) {
+            printf("%-40s ok, %u ms\n", name, millis() - start);
+            return true;
+        }
+        step(1);
+    }
+    printf("%-40s FAILED after %u ms\n", name, limit);
+    return false;
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [-n nodes] [-g group] [-p port] [-l loss] [-s seed] [-u] [-v]\n"
+           "  -n  number of simulated PLCs, 2..%d (3)\n"
+           "  -g  multicast group (239.255.70.1)\n"
+           "  -p  UDP port (%d)\n"
+           "  -l  receive loss ratio for the loss scenario (0.2)\n"
+           "  -s  random seed (1)\n"
+           "  -u  fan out over unicast ports instead of multicast\n"
+           "  -v  print the firmware log\n", name, REPLSIM_NODES_MAX, REPLICA_DEFAULT_PORT);
+}
+
+int main(int argc, char **argv)
+{
+    size_t      total = 3;
+    double      loss = 0.2;
+    unsigned    seed = 1;
+    bool        ok = true;
+    int         opt;
+
+    while ((opt = getopt(argc, argv, "n:g:p:l:s:uvh")) != -1) {
+        switch (opt) {
+            case 'n': total = strtoul(optarg, nullptr, 10); break;
+            case 'g': group.fromString(optarg); break;
+            case 'p': port = strtoul(optarg, nullptr, 10); break;
+            case 'l': loss = strtod(optarg, nullptr); break;
+            case 's': seed = strtoul(optarg, nullptr, 10); break;
+            case 'u': unicast = true; break;
+            case 'v': verbose = true; break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if (total < 2 || total > REPLSIM_NODES_MAX) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    rng.seed(seed);
+    nodes.resize(total);
+    for (size_t i = 0; i < total; i++) {
+        nodes[i] = {};
+        nodes[i].node = i + 1;
+        nodes[i].linked = true;
+    }
+
+    ReplSimNode &first = nodes[0];
+    ReplSimNode &second = nodes[1];
+    ReplSimNode &last = nodes[total - 1];
+
+    for (size_t i = 0; i < total - 1; i++) {
+        nodeStart(nodes[i], total);
+    }
+    ok &= scenario("initial sync", converged, 2 * REPLICA_SYNC_MS);
+
+    setInput(first, 1, true);
+    ok &= scenario("input delta", converged, 100);
+    setInput(first, 1, false);
+    setSocket(first, 0, true);
+    ok &= scenario("socket delta", converged, 100);
+
+    nodeStart(last, total);
+    ok &= scenario("late join resync", converged, 200);
+
+    for (ReplSimNode &sim : nodes) {
+        sim.loss = loss;
+    }
+    for (int i = 0; i < 50; i++) {
+        ReplSimNode &sim = nodes[rng() % total];
+
+        if (rng() % 2) {
+            setInput(sim, rng() % REPLSIM_MAP_INPUTS, rng() % 2);
+        } else {
+            setSocket(sim, rng() % REPLSIM_MAP_SOCKETS, rng() % 2);
+        }
+        run(5);
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "convergence with %d%% loss", (int)(loss * 100));
+    ok &= scenario(name, converged, 3 * REPLICA_SYNC_MS);
+    for (ReplSimNode &sim : nodes) {
+        sim.loss = 0.0;
+    }
+
+    nodeRestart(first, total);
+    setSocket(first, 1, !(first.image.coils & 2));
+    ok &= scenario("restart with version reset", converged, 200);
+
+    second.linked = false;
+    run(100);
+    setInput(second, 2, !(second.image.inputs & 4));
+    second.linked = true;
+    ok &= scenario("join on Wi-Fi return", converged, 2 * REPLICA_SYNC_MS);
+
+    last.running = false;
+    ok &= scenario("offline peer released", [&last]() { return released(last); },
+                   REPLICA_PEER_TIMEOUT_MS + 2 * REPLICA_SYNC_MS);
+
+    printf("\n");
+    for (ReplSimNode &sim : nodes) {
+        const ReplicaStats &stats = sim.replica->getStats();
+
+        printf("node %u: sent %u, received %u, applied %u, stale %u, joins %u, invalid %u, "
+               "conflicts %u, overflows %u, dropped %u\n", sim.node, stats.sent, stats.received,
+               stats.applied, stats.stale, stats.joins, stats.invalid, stats.conflicts,
+               stats.overflows, sim.dropped);
+        ok &= (stats.invalid == 0 && stats.conflicts == 0 && stats.overflows == 0);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __REPLSIM_ARDUINO_H__
+#define __REPLSIM_ARDUINO_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+/*
+ * Host stand-ins for the parts of the Arduino core and FreeRTOS used by
+ * src/net/replica.cpp. The simulation runs on one thread, so a mutex
+ * only has to exist.
+ */
+
+#define F(str)          (str)
+#define portMAX_DELAY   0xFFFFFFFF
+
+typedef void *SemaphoreHandle_t;
+
+class String
+{
+public:
+    String() {}
+    String(const char *str) : _str(str) {}
+    String(const std::string &str) : _str(str) {}
+
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    explicit String(T value) : _str(std::to_string(value)) {}
+
+    const char *c_str() const { return _str.c_str(); }
+    String operator+(const String &other) const { return String(_str + other._str); }
+
+private:
+    std::string _str;
+};
+
+class IPAddress
+{
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _addr{ a, b, c, d } {}
+
+    uint8_t operator[](int index) const { return _addr[index]; }
+    bool operator==(const IPAddress &other) const { return memcmp(_addr, other._addr, 4) == 0; }
+
+    bool fromString(const char *str)
+    {
+        unsigned a, b, c, d;
+        char     end;
+
+        if (sscanf(str, "%u.%u.%u.%u%c", &a, &b, &c, &d, &end) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+            return false;
+        }
+        _addr[0] = a;
+        _addr[1] = b;
+        _addr[2] = c;
+        _addr[3] = d;
+        return true;
+    }
+
+    String toString() const
+    {
+        return String(std::to_string(_addr[0]) + "." + std::to_string(_addr[1]) + "." +
+                      std::to_string(_addr[2]) + "." + std::to_string(_addr[3]));
+    }
+
+private:
+    uint8_t _addr[4] = { 0 };
+};
+
+uint32_t millis();
+uint32_t esp_random();
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    static int mutex;
+    return &mutex;
+}
+
+inline bool xSemaphoreTake(SemaphoreHandle_t lock, uint32_t timeout)
+{
+    return (lock != nullptr);
+}
+
+inline bool xSemaphoreGive(SemaphoreHandle_t lock)
+{
+    return (lock != nullptr);
+}
+
+#endif /* __REPLSIM_ARDUINO_H__ */
@@ -0,0 +1,59 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __REPLSIM_ASYNC_UDP_H__
+#define __REPLSIM_ASYNC_UDP_H__
+
+#include <Arduino.h>
+
+struct ReplSimNode;
+
+class AsyncUDPPacket
+{
+public:
+    AsyncUDPPacket(uint8_t *data, size_t length, const IPAddress &ip) : _data(data), _length(length), _ip(ip) {}
+
+    uint8_t *data() { return _data; }
+    size_t length() const { return _length; }
+    IPAddress remoteIP() const { return _ip; }
+
+private:
+    uint8_t     *_data;
+    size_t      _length;
+    IPAddress   _ip;
+};
+
+typedef std::function<void(AsyncUDPPacket &packet)> AuPacketHandlerFunction;
+
+/*
+ * Loopback socket of the simulation. It belongs to the node that was
+ * current when it was opened, its packets are handed to that node
+ * only, see replSimPoll().
+ */
+class AsyncUDP
+{
+public:
+    ~AsyncUDP();
+    bool listenMulticast(const IPAddress &addr, uint16_t port);
+    void onPacket(AuPacketHandlerFunction cb);
+    size_t writeTo(const uint8_t *data, size_t len, const IPAddress &addr, uint16_t port);
+    void close();
+
+private:
+    int                     _fd = -1;
+    uint16_t                _port = 0;
+    ReplSimNode             *_owner = nullptr;
+    AuPacketHandlerFunction _handler;
+
+    friend void replSimPoll(unsigned timeout);
+};
+
+#endif /* __REPLSIM_ASYNC_UDP_H__ */
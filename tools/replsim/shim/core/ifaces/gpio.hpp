@@ -0,0 +1,35 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __GPIO_HPP__
+#define __GPIO_HPP__
+
+#include <Arduino.h>
+
+/*
+ * Only virtual pins are simulated, each node has its own set.
+ */
+typedef struct {
+    uint16_t    id;
+    bool        state;
+    bool        enabled;
+} GpioPin;
+
+class GpioClass
+{
+public:
+    void write(GpioPin *pin, bool val);
+    bool addVirtual(uint16_t id, GpioPin **pin);
+};
+
+extern GpioClass Gpio;
+
+#endif /* __GPIO_HPP__ */
@@ -0,0 +1,41 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __REG_IMAGE_HPP__
+#define __REG_IMAGE_HPP__
+
+#include <Arduino.h>
+
+#include "core/ifaces/gpio.hpp"
+
+/*
+ * Sizes as in include/core/regimage.hpp, the image of a node is set by
+ * the simulation instead of its sockets and inputs.
+ */
+#define REGIMAGE_COILS          32
+#define REGIMAGE_INPUTS         64
+
+typedef struct {
+    uint32_t    version;
+    uint32_t    coils;
+    uint32_t    sockets;
+    uint64_t    inputs;
+} RegImageData;
+
+class RegImageClass
+{
+public:
+    void read(RegImageData &data);
+};
+
+extern RegImageClass RegImage;
+
+#endif /* __REG_IMAGE_HPP__ */
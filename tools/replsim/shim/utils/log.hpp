@@ -0,0 +1,27 @@
+/**********************************************************************/
+/*                                                                    */
+/* Programmable Logic Controller for ESP microcontrollers             */
+/*                                                                    */
+/* Copyright (C) 2024-2025 Denisov Foundation Limited                 */
+/* License: GPLv3                                                     */
+/* Written by Sergey Denisov aka LittleBuster                         */
+/* Email: DenisovFoundationLtd@gmail.com                              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef __LOG_HPP__
+#define __LOG_HPP__
+
+#include <Arduino.h>
+
+class LogClass
+{
+public:
+    void info(const String &mod, const String &msg);
+    void error(const String &mod, const String &msg);
+    void warning(const String &mod, const String &msg);
+};
+
+extern LogClass Log;
+
+#endif /* __LOG_HPP__ */
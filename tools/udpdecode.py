@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+#
+# Programmable Logic Controller for ESP microcontrollers
+#
+# Copyright (C) 2024-2025 Denisov Foundation Limited
+# License: GPLv3
+#
+# Decoder for the PLC UDP telemetry stream. Reports frame loss,
+# reordering and inter-arrival jitter, optionally dumps every frame.
+# A PLC restart starts the sequence over, it is detected by a large
+# backwards jump of the sequence or of the uptime and is not counted
+# as reordering.
+#
+
+import argparse
+import socket
+import statistics
+import struct
+import time
+
+MAGIC = 0x55504346
+VERSION = 1
+
+HEADER = struct.Struct("<IHHII")
+IMAGE = struct.Struct("<IIIQ32h")
+FRAME_SIZE = HEADER.size + IMAGE.size
+
+REORDER_WINDOW = 64
+RESTART_TIME_MS = 1000
+
+
+def open_socket(port, group):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", port))
+    if group:
+        mreq = struct.pack("4s4s", socket.inet_aton(group), socket.inet_aton("0.0.0.0"))
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+    return sock
+
+
+def decode(data):
+    if len(data) != FRAME_SIZE:
+        return None
+    magic, version, size, seq, ms = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or size != FRAME_SIZE:
+        return None
+    ver, coils, sockets, inputs, *iregs = IMAGE.unpack_from(data, HEADER.size)
+    return {
+        "seq": seq,
+        "time": ms,
+        "version": ver,
+        "coils": coils,
+        "sockets": sockets,
+        "inputs": inputs,
+        "iregs": iregs,
+    }
+
+
+def report(stats, gaps):
+    jitter = "n/a"
+    if len(gaps) > 1:
+        mean = statistics.mean(gaps)
+        jitter = "mean %.2f ms, stdev %.2f ms, max %.2f ms" % (
+            mean, statistics.pstdev(gaps), max(abs(g - mean) for g in gaps))
+    total = stats["received"] + stats["lost"]
+    loss = 100.0 * stats["lost"] / total if total else 0.0
+    print("frames %d, lost %d (%.2f%%), reordered %d, duplicated %d, invalid %d, restarts %d, jitter: %s" % (
+        stats["received"], stats["lost"], loss, stats["reordered"], stats["duplicated"],
+        stats["invalid"], stats["restarts"], jitter))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="PLC UDP telemetry decoder")
+    parser.add_argument("-p", "--port", type=int, default=5005, help="UDP port")
+    parser.add_argument("-g", "--group", help="multicast group to join")
+    parser.add_argument("-i", "--interval", type=float, default=5.0, help="report interval, s")
+    parser.add_argument("-d", "--dump", action="store_true", help="print every frame")
+    args = parser.parse_args()
+
+    sock = open_socket(args.port, args.group)
+    stats = {"received": 0, "lost": 0, "reordered": 0, "duplicated": 0, "invalid": 0, "restarts": 0}
+    gaps = []
+    last_seq = None
+    last_time = None
+    last_rx = None
+    next_report = time.monotonic() + args.interval
+
+    while True:
+        data, addr = sock.recvfrom(2048)
+        now = time.monotonic()
+        frame = decode(data)
+
+        if frame is None:
+            stats["invalid"] += 1
+            continue
+
+        stats["received"] += 1
+        if last_seq is not None and (frame["seq"] + REORDER_WINDOW < last_seq or
+                                     frame["time"] + RESTART_TIME_MS < last_time):
+            stats["restarts"] += 1
+            last_seq = None
+            last_time = None
+            print("%s restarted, seq %d time %d" % (addr[0], frame["seq"], frame["time"]))
+        if last_seq is not None:
+            if frame["seq"] > last_seq:
+                stats["lost"] += frame["seq"] - last_seq - 1
+            elif frame["seq"] < last_seq:
+                stats["reordered"] += 1
+                stats["lost"] = max(stats["lost"] - 1, 0)
+            else:
+                stats["duplicated"] += 1
+        if last_rx is not None:
+            gaps.append((now - last_rx) * 1000.0)
+        if last_seq is None or frame["seq"] > last_seq:
+            last_seq = frame["seq"]
+            last_time = frame["time"]
+        last_rx = now
+
+        if args.dump:
+            print("%s seq %d time %d version %d coils %08x inputs %016x temp %.1f" % (
+                addr[0], frame["seq"], frame["time"], frame["version"],
+                frame["coils"], frame["inputs"], frame["iregs"][0] / 10.0))
+
+        if now >= next_report:
+            report(stats, gaps)
+            gaps.clear()
+            next_report = now + args.interval
+
+
+if __name__ == "__main__":
+    main()